@@ -0,0 +1,65 @@
+#pragma once
+
+#include <chrono>
+#include <cstddef>
+#include <cstdint>
+#include <cstdio>
+#include <string_view>
+
+namespace bench
+{
+
+/**
+ * Keeps the compiler from optimising away the computation of a value.
+ *
+ * @param[in] value - the value to keep
+ */
+template <typename T>
+inline void doNotOptimize(const T& value)
+{
+    asm volatile("" : : "r,m"(value) : "memory");
+}
+
+/**
+ * Runs a function repeatedly for at least minTime and prints the average
+ * time per call, along with the number of bytes each call processes.
+ *
+ * @param[in] name - name of the benchmark
+ * @param[in] bytesPerOp - number of bytes processed by each call
+ * @param[in] fn - the function to measure
+ * @param[in] minTime - minimum time to spend measuring
+ */
+template <typename Fn>
+void run(std::string_view name, size_t bytesPerOp, Fn&& fn,
+         std::chrono::nanoseconds minTime = std::chrono::milliseconds(200))
+{
+    using clock = std::chrono::steady_clock;
+
+    // Warm up the caches before measuring.
+    fn();
+
+    uint64_t iterations = 0;
+    uint64_t batch = 1;
+    auto start = clock::now();
+    auto elapsed = clock::duration::zero();
+    while (elapsed < minTime)
+    {
+        for (uint64_t i = 0; i < batch; i++)
+        {
+            fn();
+        }
+        iterations += batch;
+        batch *= 2;
+        elapsed = clock::now() - start;
+    }
+
+    double nsPerOp =
+        std::chrono::duration<double, std::nano>(elapsed).count() / iterations;
+    double mbPerSec = nsPerOp > 0 ? (bytesPerOp * 1e3) / nsPerOp : 0;
+
+    std::printf("%-48.*s %12.1f ns/op %8zu bytes/op %10.1f MB/s\n",
+                static_cast<int>(name.size()), name.data(), nsPerOp,
+                bytesPerOp, mbPerSec);
+}
+
+} // namespace bench
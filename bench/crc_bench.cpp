@@ -0,0 +1,66 @@
+#include "benchmark.hpp"
+#include "writefrudata.hpp"
+
+#include <cstdio>
+#include <cstdlib>
+#include <string>
+#include <vector>
+
+namespace
+{
+
+/**
+ * The byte at a time checksum calculateCRC() used before it was
+ * vectorised, kept as the baseline.
+ */
+unsigned char legacyCalculateCRC(const unsigned char* data, size_t len)
+{
+    char crc = 0;
+    for (size_t byte = 0; byte < len; byte++)
+    {
+        crc += *data++;
+    }
+    return (-crc);
+}
+
+} // namespace
+
+int main()
+{
+    std::vector<uint8_t> src(65536 + 16);
+    for (size_t i = 0; i < src.size(); i++)
+    {
+        src[i] = static_cast<uint8_t>(i * 131 + (i >> 8));
+    }
+
+    // Every length and alignment up to a few vectors, to cover the tails.
+    for (size_t offset = 0; offset < 16; offset++)
+    {
+        for (size_t len = 0; len < 100; len++)
+        {
+            const uint8_t* data = src.data() + offset;
+            unsigned char expected = legacyCalculateCRC(data, len);
+            if (calculateCRC(data, len) != expected)
+            {
+                std::fprintf(stderr, "Mismatch at offset %zu, length %zu\n",
+                             offset, len);
+                return EXIT_FAILURE;
+            }
+        }
+    }
+
+    // The common header, typical info areas, the largest info area
+    // (255 * 8 bytes), and whole EEPROMs for scrubbing.
+    for (size_t len : {8, 64, 256, 512, 2040, 8192, 65536})
+    {
+        auto suffix = "/" + std::to_string(len);
+        bench::run("legacy_calculate_crc" + suffix, len, [&] {
+            bench::doNotOptimize(legacyCalculateCRC(src.data(), len));
+        });
+        bench::run("calculate_crc" + suffix, len, [&] {
+            bench::doNotOptimize(calculateCRC(src.data(), len));
+        });
+    }
+
+    return EXIT_SUCCESS;
+}
@@ -0,0 +1,386 @@
+#include "benchmark.hpp"
+#include "fru_area.hpp"
+#include "frup.hpp"
+#include "writefrudata.hpp"
+
+#include <cstdio>
+#include <cstdlib>
+#include <memory>
+#include <span>
+#include <string>
+#include <variant>
+#include <vector>
+
+namespace
+{
+
+/**
+ * Builds FRU images for the corpus, with whichever areas and fields each of
+ * them needs.
+ */
+class FruBuilder
+{
+  public:
+    /**
+     * Start a new info area.
+     *
+     * @param[in] prefix - the bytes between the area length and the fields,
+     *                     e.g. the language code
+     */
+    FruBuilder& area(std::vector<uint8_t> prefix)
+    {
+        current = {1, 0};
+        current.insert(current.end(), prefix.begin(), prefix.end());
+        return *this;
+    }
+
+    /**
+     * Add a text field to the current area.
+     */
+    FruBuilder& text(const std::string& value)
+    {
+        current.push_back(0xC0 | value.size());
+        current.insert(current.end(), value.begin(), value.end());
+        return *this;
+    }
+
+    /**
+     * Add a binary field to the current area.
+     */
+    FruBuilder& binary(size_t len)
+    {
+        current.push_back(len);
+        for (size_t i = 0; i < len; i++)
+        {
+            current.push_back(static_cast<uint8_t>(i * 37 + 11));
+        }
+        return *this;
+    }
+
+    /**
+     * Finish the current area and place it at the given common header
+     * entry.
+     */
+    FruBuilder& end(size_t entry)
+    {
+        current.push_back(0xC1);
+        while ((current.size() + 1) % 8)
+        {
+            current.push_back(0);
+        }
+        current[1] = (current.size() + 1) / 8;
+        current.push_back(calculateCRC(current.data(), current.size()));
+        place(entry, current);
+        return *this;
+    }
+
+    /**
+     * Add a record to the multirecord area.
+     */
+    FruBuilder& record(uint8_t type, std::vector<uint8_t> data)
+    {
+        records.push_back({type, 0x02, static_cast<uint8_t>(data.size()),
+                           calculateCRC(data.data(), data.size()), 0});
+        records.back().insert(records.back().end(), data.begin(), data.end());
+        return *this;
+    }
+
+    /**
+     * Finish the image.
+     */
+    std::vector<uint8_t> build()
+    {
+        if (!records.empty())
+        {
+            std::vector<uint8_t> multi;
+            for (size_t i = 0; i < records.size(); i++)
+            {
+                auto& record = records[i];
+                if (i == records.size() - 1)
+                {
+                    record[1] |= IPMI_FRU_MULTIREC_END_OF_LIST;
+                }
+                record[4] = calculateCRC(record.data(), 4);
+                multi.insert(multi.end(), record.begin(), record.end());
+            }
+            place(IPMI_FRU_MULTI_OFFSET, multi);
+        }
+
+        image[0] = IPMI_FRU_HDR_BYTE_ZERO;
+        image[IPMI_FRU_HDR_CRC_OFFSET] =
+            calculateCRC(image.data(), IPMI_FRU_HDR_CRC_OFFSET);
+        return image;
+    }
+
+  private:
+    void place(size_t entry, const std::vector<uint8_t>& area)
+    {
+        image.resize((image.size() + 7) / 8 * 8);
+        image[entry] = image.size() / 8;
+        image.insert(image.end(), area.begin(), area.end());
+    }
+
+    std::vector<uint8_t> image = std::vector<uint8_t>(8);
+    std::vector<uint8_t> current;
+    std::vector<std::vector<uint8_t>> records;
+};
+
+struct CorpusEntry
+{
+    std::string name;
+    std::vector<uint8_t> image;
+};
+
+std::vector<CorpusEntry> makeCorpus()
+{
+    std::vector<CorpusEntry> corpus;
+
+    // Only the mandatory fields, all of them empty.
+    corpus.push_back({"minimal", FruBuilder()
+                                     .area({0x19, 0, 0, 0})
+                                     .text("")
+                                     .text("")
+                                     .text("")
+                                     .text("")
+                                     .text("")
+                                     .end(IPMI_FRU_BOARD_OFFSET)
+                                     .build()});
+
+    // What a server board FRU usually has.
+    corpus.push_back({"typical", FruBuilder()
+                                     .area({0x17})
+                                     .text("CH-PN-0001")
+                                     .text("CH-SN-0001")
+                                     .end(IPMI_FRU_CHASSIS_OFFSET)
+                                     .area({0x19, 0x10, 0x20, 0x30})
+                                     .text("Acme Corporation")
+                                     .text("Server Board X100")
+                                     .text("BSN0123456789")
+                                     .text("BPN-0987654")
+                                     .text("fru-v1")
+                                     .end(IPMI_FRU_BOARD_OFFSET)
+                                     .area({0x19})
+                                     .text("Acme Corporation")
+                                     .text("Server X100")
+                                     .text("X100-2U")
+                                     .text("Rev B")
+                                     .text("PSN0123456789")
+                                     .text("ASSET-42")
+                                     .text("fru-v1")
+                                     .end(IPMI_FRU_PRODUCT_OFFSET)
+                                     .build()});
+
+    // Every custom field, at the longest a field can be.
+    FruBuilder custom;
+    std::string longField(63, 'x');
+    custom.area({0x17}).text(longField).text(longField);
+    for (int i = 0; i < OPENBMC_VPD_KEY_CUSTOM_FIELDS_MAX; i++)
+    {
+        custom.text("key" + std::to_string(i) + ":" + longField.substr(5));
+    }
+    custom.end(IPMI_FRU_CHASSIS_OFFSET).area({0x19, 0x10, 0x20, 0x30});
+    for (int i = 0; i < 5 + OPENBMC_VPD_KEY_CUSTOM_FIELDS_MAX; i++)
+    {
+        custom.text(longField);
+    }
+    custom.end(IPMI_FRU_BOARD_OFFSET).area({0x19});
+    for (int i = 0; i < 7 + OPENBMC_VPD_KEY_CUSTOM_FIELDS_MAX; i++)
+    {
+        custom.text(longField);
+    }
+    corpus.push_back(
+        {"max_custom", custom.end(IPMI_FRU_PRODUCT_OFFSET).build()});
+
+    // Binary fields, converted to hex strings.
+    FruBuilder binary;
+    binary.area({0x19, 0x10, 0x20, 0x30})
+        .text("Acme Corporation")
+        .text("Server Board X100")
+        .binary(16)
+        .binary(16)
+        .binary(8);
+    for (int i = 0; i < 4; i++)
+    {
+        binary.binary(63);
+    }
+    corpus.push_back({"binary", binary.end(IPMI_FRU_BOARD_OFFSET).build()});
+
+    // A power supply, with its ratings in the multirecord area.
+    std::vector<uint8_t> psuInfo{
+        0x26, 0x02, 0x58, 0x02, 30, 5,    0x28, 0x23, 0x50, 0x67, 0x50, 0x46,
+        0x50, 0x67, 47,   63,   20, 0x0A, 0x8A, 0x12, 0x12, 0,    0,    0x10};
+    corpus.push_back(
+        {"multirecord",
+         FruBuilder()
+             .area({0x19})
+             .text("Acme Power")
+             .text("PSU 550W")
+             .text("PSU-550")
+             .text("Rev A")
+             .text("PSN0123456789")
+             .text("")
+             .text("")
+             .end(IPMI_FRU_PRODUCT_OFFSET)
+             .record(0x00, psuInfo)
+             .record(0x01, {0x81, 0xB0, 0x04, 0xF6, 0xFF, 0x0A, 0x00, 120, 0,
+                            0, 0, 0x10, 0x27})
+             .record(0x01, {0x02, 0xF4, 0x01, 0xF6, 0xFF, 0x0A, 0x00, 50, 0,
+                            0, 0, 0xE8, 0x03})
+             .record(0x03, {0x05, 'p', 's', 'u', '0'})
+             .build()});
+
+    return corpus;
+}
+
+/**
+ * Set up the areas of a FRU the way validating it does.
+ */
+FruAreaVector makeFruAreas()
+{
+    FruAreaVector fruAreaVec;
+    for (int type = IPMI_FRU_AREA_INTERNAL_USE;
+         type < IPMI_FRU_AREA_TYPE_MAX; type++)
+    {
+        auto fruArea = std::make_unique<IPMIFruArea>(
+            0, static_cast<ipmi_fru_area_type>(type));
+        fruArea->setPresent(true);
+        fruAreaVec.emplace_back(std::move(fruArea));
+    }
+    return fruAreaVec;
+}
+
+/**
+ * Stands in for an inventory manager that takes every call.
+ */
+int acceptNotify(ipmi::vpd::ObjectMap&, std::span<const uint8_t>)
+{
+    return 0;
+}
+
+/**
+ * Stands in for an inventory manager that fails every call.
+ */
+int rejectNotify(ipmi::vpd::ObjectMap& objects, std::span<const uint8_t>)
+{
+    bench::doNotOptimize(objects);
+    return -1;
+}
+
+/**
+ * Find a FRU ID the generated tables map to something.
+ */
+int findMappedFruId()
+{
+    // Fail every call, so that nothing counts as published yet.
+    bool mapped = false;
+    auto reject = [&mapped](ipmi::vpd::ObjectMap& objects,
+                            std::span<const uint8_t>) {
+        mapped = !objects.empty();
+        return -1;
+    };
+    for (int fruid = 0; fruid <= UINT8_MAX; fruid++)
+    {
+        ParsedFru parsedFru{static_cast<uint8_t>(fruid), {}};
+        updateInventory({&parsedFru, 1}, reject);
+        if (mapped)
+        {
+            return fruid;
+        }
+    }
+    return -1;
+}
+
+/**
+ * Make the next update of a FRU send all of its objects again, by failing
+ * an update that changes it.
+ */
+void unpublish(uint8_t fruid)
+{
+    ParsedFru parsedFru{fruid, {}};
+    for (auto& [key, value] : parsedFru.info)
+    {
+        value = std::string("-");
+    }
+    updateInventory({&parsedFru, 1}, rejectNotify);
+}
+
+} // namespace
+
+int main()
+{
+    auto corpus = makeCorpus();
+
+    int fruid = findMappedFruId();
+    if (fruid < 0)
+    {
+        std::fprintf(stderr, "No FRU ID in the FRU YAML maps to anything\n");
+        return EXIT_FAILURE;
+    }
+
+    for (const auto& [name, image] : corpus)
+    {
+        // Make sure that the image parses, and what its areas add up to.
+        auto fruAreaVec = makeFruAreas();
+        IPMIFruInfo info;
+        size_t areaBytes = 0;
+        if (ipmiValidateCommonHeader(image.data(), image.size()) < 0 ||
+            ipmiPopulateFruAreas(image.data(), image.size(), fruAreaVec) < 0)
+        {
+            std::fprintf(stderr, "Corpus entry %s is not valid\n",
+                         name.c_str());
+            return EXIT_FAILURE;
+        }
+        for (const auto& fruArea : fruAreaVec)
+        {
+            areaBytes += fruArea->getLength();
+            if (parse_fru_area(fruArea->getType(), fruArea->getData(), info) <
+                0)
+            {
+                std::fprintf(stderr, "Corpus entry %s does not parse\n",
+                             name.c_str());
+                return EXIT_FAILURE;
+            }
+        }
+
+        auto suffix = "/" + name;
+        bench::run("calculate_crc" + suffix, image.size(), [&] {
+            bench::doNotOptimize(calculateCRC(image.data(), image.size()));
+        });
+        bench::run("validate_common_header" + suffix,
+                   sizeof(struct common_header), [&] {
+                       bench::doNotOptimize(ipmiValidateCommonHeader(
+                           image.data(), image.size()));
+                   });
+        bench::run("populate_fru_areas" + suffix, image.size(), [&] {
+            auto areas = makeFruAreas();
+            bench::doNotOptimize(
+                ipmiPopulateFruAreas(image.data(), image.size(), areas));
+        });
+        bench::run("parse_fru_area" + suffix, areaBytes, [&] {
+            IPMIFruInfo parsed;
+            for (const auto& fruArea : fruAreaVec)
+            {
+                parse_fru_area(fruArea->getType(), fruArea->getData(), parsed);
+            }
+            bench::doNotOptimize(parsed);
+        });
+
+        // With the inventory manager failing every call, each update sends
+        // all of the FRU's objects, like the first one after boot does.
+        ParsedFru parsedFru{static_cast<uint8_t>(fruid), info};
+        unpublish(parsedFru.fruid);
+        bench::run("update_inventory_full" + suffix, image.size(), [&] {
+            bench::doNotOptimize(
+                updateInventory({&parsedFru, 1}, rejectNotify));
+        });
+
+        // An unchanged FRU, like most of the updates after that.
+        updateInventory({&parsedFru, 1}, acceptNotify);
+        bench::run("update_inventory_unchanged" + suffix, image.size(), [&] {
+            bench::doNotOptimize(
+                updateInventory({&parsedFru, 1}, acceptNotify));
+        });
+    }
+
+    return EXIT_SUCCESS;
+}
@@ -0,0 +1,84 @@
+#include "benchmark.hpp"
+#include "frup.hpp"
+
+#include <cstdio>
+#include <cstdlib>
+#include <cstring>
+#include <string>
+#include <vector>
+
+namespace
+{
+
+/**
+ * The snprintf/strncat conversion _append_to_dict() used before
+ * fru_bin_to_hex(), kept as the baseline. The buffer length is a size_t
+ * here, it used to be a char, which overflowed for 63 byte fields.
+ */
+std::string legacyBinToHex(const uint8_t* data, size_t len)
+{
+    char binByte[3] = {0};
+    size_t binInAsciiLen = len * 2 + 3;
+    char* binInAscii = static_cast<char*>(std::malloc(binInAsciiLen));
+    char* binCopy = &binInAscii[2];
+
+    std::memset(binInAscii, 0x0, binInAsciiLen);
+    for (size_t val = 0; val < len; val++)
+    {
+        std::snprintf(binByte, 3, "%02x", data[val]);
+#pragma GCC diagnostic push
+#ifdef __clang__
+#pragma clang diagnostic ignored "-Wdeprecated-declarations"
+#else
+#pragma GCC diagnostic ignored "-Wstringop-truncation"
+#endif
+        std::strncat(binCopy, binByte, 2);
+#pragma GCC diagnostic pop
+    }
+    if (len > 0)
+    {
+        std::memcpy(binInAscii, "0x", 2);
+    }
+
+    std::string result(binInAscii);
+    std::free(binInAscii);
+    return result;
+}
+
+} // namespace
+
+int main()
+{
+    // Binary fields are at most 63 bytes, the type/length byte has 6 bits of
+    // length.
+    for (size_t len : {4, 16, 32, 63})
+    {
+        std::vector<uint8_t> field(len);
+        for (size_t i = 0; i < len; i++)
+        {
+            field[i] = static_cast<uint8_t>(i * 37 + 11);
+        }
+
+        std::string expected = legacyBinToHex(field.data(), len);
+        std::string actual;
+        fru_bin_to_hex(field.data(), len, actual);
+        if (actual != expected)
+        {
+            std::fprintf(stderr, "Mismatch for %zu bytes: %s != %s\n", len,
+                         actual.c_str(), expected.c_str());
+            return EXIT_FAILURE;
+        }
+
+        auto suffix = "/" + std::to_string(len);
+        bench::run("legacy_bin_to_hex" + suffix, len, [&] {
+            bench::doNotOptimize(legacyBinToHex(field.data(), len));
+        });
+        bench::run("fru_bin_to_hex" + suffix, len, [&] {
+            std::string out;
+            fru_bin_to_hex(field.data(), len, out);
+            bench::doNotOptimize(out);
+        });
+    }
+
+    return EXIT_SUCCESS;
+}
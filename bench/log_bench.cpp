@@ -0,0 +1,93 @@
+#include "config.h"
+
+#include "benchmark.hpp"
+#include "fru_log.hpp"
+#include "frup.hpp"
+#include "writefrudata.hpp"
+
+#include <cstdio>
+#include <cstdlib>
+#include <string>
+#include <vector>
+
+namespace
+{
+
+/**
+ * Build a board info area whose fields are all at their longest, with a
+ * binary custom field, the most logging the area parser does.
+ *
+ * @return the area, from its format version byte to its checksum
+ */
+std::vector<uint8_t> makeBoardArea()
+{
+    // Format version, length, language code and manufacturing date.
+    std::vector<uint8_t> area = {1, 0, 0, 0x10, 0x20, 0x30};
+
+    auto text = [&area](char fill) {
+        area.push_back(0xC0 | 63);
+        area.insert(area.end(), 63, fill);
+    };
+    for (char fill : {'M', 'N', 'S', 'P', 'F', 'C'})
+    {
+        text(fill);
+    }
+
+    area.push_back(63);
+    for (size_t i = 0; i < 63; i++)
+    {
+        area.push_back(static_cast<uint8_t>(i * 37 + 11));
+    }
+
+    area.push_back(0xC1);
+    while ((area.size() + 1) % 8)
+    {
+        area.push_back(0);
+    }
+    area[1] = (area.size() + 1) / 8;
+    area.push_back(calculateCRC(area.data(), area.size()));
+    return area;
+}
+
+} // namespace
+
+int main()
+{
+    // What each call to lg2::debug costs on the parsing path, and what
+    // FRU_DEBUG leaves of it. Build with -Dfru_debug_logging=false and
+    // compare to see the difference for whole areas.
+    std::printf("fru_debug_logging: %s\n", FRU_DEBUG_LOGGING ? "true" : "false");
+
+    std::string value = "0x0b30557aa4cff61d";
+    bench::run("lg2_debug_field", value.size(), [&] {
+        lg2::debug("_append_to_dict: VPD Key = [{KEY}] : Len = [{LEN}] : "
+                   "Val = [{VAL}]",
+                   "KEY", "Board Serial Number", "LEN", value.size(), "VAL",
+                   value);
+    });
+    bench::run("fru_debug_field", value.size(), [&] {
+        FRU_DEBUG("_append_to_dict: VPD Key = [{KEY}] : Len = [{LEN}] : "
+                  "Val = [{VAL}]",
+                  "KEY", "Board Serial Number", "LEN", value.size(), "VAL",
+                  value);
+        bench::doNotOptimize(value);
+    });
+
+    auto area = makeBoardArea();
+    IPMIFruInfo info;
+    if (parse_fru_area(IPMI_FRU_AREA_BOARD_INFO, area, info) < 0)
+    {
+        std::fprintf(stderr, "Board area is not valid\n");
+        return EXIT_FAILURE;
+    }
+
+    std::string suffix = FRU_DEBUG_LOGGING ? "/debug_on" : "/debug_off";
+    bench::run("parse_board_area" + suffix, area.size(), [&] {
+        IPMIFruInfo info;
+        bench::doNotOptimize(
+            parse_fru_area(IPMI_FRU_AREA_BOARD_INFO, area, info));
+        bench::doNotOptimize(info);
+    });
+
+    return EXIT_SUCCESS;
+}
@@ -0,0 +1,404 @@
+#include "eeprom_monitor.hpp"
+
+#include "fru_stats.hpp"
+#include "writefrudata.hpp"
+
+#include <linux/netlink.h>
+#include <sys/epoll.h>
+#include <sys/inotify.h>
+#include <sys/socket.h>
+#include <sys/un.h>
+#include <systemd/sd-event.h>
+#include <unistd.h>
+
+#include <phosphor-logging/lg2.hpp>
+#include <sdbusplus/bus.hpp>
+#include <sdbusplus/timer.hpp>
+
+#include <cctype>
+#include <cerrno>
+#include <charconv>
+#include <cstring>
+#include <filesystem>
+#include <map>
+#include <set>
+#include <string_view>
+
+namespace
+{
+
+/**
+ * Watches the EEPROMs of a set of FRUs and publishes them again when they
+ * are added or change.
+ */
+class EepromMonitor
+{
+  public:
+    EepromMonitor() = delete;
+    EepromMonitor(const EepromMonitor&) = delete;
+    EepromMonitor& operator=(const EepromMonitor&) = delete;
+    EepromMonitor(EepromMonitor&&) = delete;
+    EepromMonitor& operator=(EepromMonitor&&) = delete;
+
+    /**
+     * Construct an EepromMonitor.
+     *
+     * @param[in] bus - the bus to publish the FRUs on.
+     * @param[in] event - the event loop to watch for events from.
+     * @param[in] fruFiles - the IDs and filenames of the FRUs.
+     * @param[in] debounce - how long to collect events before reading.
+     */
+    EepromMonitor(sdbusplus::bus_t& bus, sd_event* event,
+                  std::vector<std::pair<uint8_t, std::string>> fruFiles,
+                  std::chrono::milliseconds debounce) :
+        bus(bus), event(event), fruFiles(std::move(fruFiles)),
+        debounce(debounce), debounceTimer(event, [this]() { readPending(); })
+    {}
+
+    ~EepromMonitor()
+    {
+        for (int fd : {ueventFd, inotifyFd, socketFd})
+        {
+            if (fd >= 0)
+            {
+                close(fd);
+            }
+        }
+    }
+
+    /**
+     * Start watching the EEPROMs and listening for requests.
+     *
+     * @param[in] socketPath - where to create the request socket.
+     * @return non-zero on failure
+     */
+    int start(const std::string& socketPath)
+    {
+        for (size_t i = 0; i < fruFiles.size(); i++)
+        {
+            std::filesystem::path file = fruFiles[i].second;
+
+            // The EEPROM file of an I2C device is <device>/eeprom in sysfs,
+            // the kernel announces it by the name of that directory.
+            if (fruFiles[i].second.starts_with("/sys/"))
+            {
+                devices.emplace(file.parent_path().filename(), i);
+            }
+            else
+            {
+                files.emplace(file, i);
+            }
+        }
+
+        if (!devices.empty() && watchUevents() < 0)
+        {
+            return -1;
+        }
+
+        if (!files.empty() && watchFiles() < 0)
+        {
+            return -1;
+        }
+
+        return listen(socketPath);
+    }
+
+    /**
+     * Read and publish all the FRUs.
+     */
+    void readAll()
+    {
+        for (size_t i = 0; i < fruFiles.size(); i++)
+        {
+            pending.insert(i);
+        }
+        readPending();
+    }
+
+  private:
+    int watchUevents()
+    {
+        ueventFd = socket(AF_NETLINK, SOCK_DGRAM | SOCK_NONBLOCK | SOCK_CLOEXEC,
+                          NETLINK_KOBJECT_UEVENT);
+        if (ueventFd < 0)
+        {
+            lg2::error("Unable to open uevent socket, error: {ERRNO}", "ERRNO",
+                       std::strerror(errno));
+            return -1;
+        }
+
+        sockaddr_nl addr{};
+        addr.nl_family = AF_NETLINK;
+        addr.nl_groups = 1; // kernel events
+        if (bind(ueventFd, reinterpret_cast<sockaddr*>(&addr), sizeof(addr)) <
+            0)
+        {
+            lg2::error("Unable to bind uevent socket, error: {ERRNO}", "ERRNO",
+                       std::strerror(errno));
+            return -1;
+        }
+
+        return addIo(ueventFd, onUevent);
+    }
+
+    int watchFiles()
+    {
+        inotifyFd = inotify_init1(IN_NONBLOCK | IN_CLOEXEC);
+        if (inotifyFd < 0)
+        {
+            lg2::error("Unable to initialize inotify, error: {ERRNO}", "ERRNO",
+                       std::strerror(errno));
+            return -1;
+        }
+
+        // Watch the directories, files that are replaced rather than
+        // rewritten would take a watch on the file itself with them.
+        for (const auto& [file, index] : files)
+        {
+            auto dir = file.parent_path();
+            int wd = inotify_add_watch(inotifyFd, dir.c_str(),
+                                       IN_CLOSE_WRITE | IN_MOVED_TO);
+            if (wd < 0)
+            {
+                lg2::error("Unable to watch {DIR}, error: {ERRNO}", "DIR",
+                           dir.string(), "ERRNO", std::strerror(errno));
+                return -1;
+            }
+            watches[wd] = dir;
+        }
+
+        return addIo(inotifyFd, onInotify);
+    }
+
+    int listen(const std::string& socketPath)
+    {
+        sockaddr_un addr{};
+        addr.sun_family = AF_UNIX;
+        if (socketPath.size() >= sizeof(addr.sun_path))
+        {
+            lg2::error("Socket path {PATH} is too long", "PATH", socketPath);
+            return -1;
+        }
+        std::strcpy(addr.sun_path, socketPath.c_str());
+
+        socketFd =
+            socket(AF_UNIX, SOCK_DGRAM | SOCK_NONBLOCK | SOCK_CLOEXEC, 0);
+        if (socketFd < 0)
+        {
+            lg2::error("Unable to open request socket, error: {ERRNO}", "ERRNO",
+                       std::strerror(errno));
+            return -1;
+        }
+
+        unlink(socketPath.c_str());
+        if (bind(socketFd, reinterpret_cast<sockaddr*>(&addr), sizeof(addr)) <
+            0)
+        {
+            lg2::error("Unable to bind {PATH}, error: {ERRNO}", "PATH",
+                       socketPath, "ERRNO", std::strerror(errno));
+            return -1;
+        }
+
+        return addIo(socketFd, onRequest);
+    }
+
+    int addIo(int fd, sd_event_io_handler_t handler)
+    {
+        int rc = sd_event_add_io(event, nullptr, fd, EPOLLIN, handler, this);
+        if (rc < 0)
+        {
+            lg2::error("Unable to add event source, error: {ERRNO}", "ERRNO",
+                       std::strerror(-rc));
+            return -1;
+        }
+        return 0;
+    }
+
+    /**
+     * Note that a FRU needs to be read and make sure it will be.
+     *
+     * @param[in] index - the index of the FRU in fruFiles
+     */
+    void queue(size_t index)
+    {
+        pending.insert(index);
+        if (!debounceTimer.isRunning())
+        {
+            debounceTimer.start(debounce);
+        }
+    }
+
+    void readPending()
+    {
+        std::vector<std::pair<uint8_t, std::string>> batch;
+        for (size_t index : pending)
+        {
+            batch.push_back(fruFiles[index]);
+        }
+        pending.clear();
+
+        validateFRUAreas(batch, bus);
+    }
+
+    static int onUevent(sd_event_source*, int fd, uint32_t, void* userdata)
+    {
+        auto monitor = static_cast<EepromMonitor*>(userdata);
+        char buf[8192];
+        ssize_t len;
+
+        while ((len = recv(fd, buf, sizeof(buf) - 1, 0)) > 0)
+        {
+            buf[len] = '\0';
+
+            // The message starts with "<action>@<devpath>".
+            std::string_view header(buf);
+            auto at = header.find('@');
+            if (at == std::string_view::npos)
+            {
+                continue;
+            }
+            auto action = header.substr(0, at);
+            if (action != "add" && action != "bind" && action != "change")
+            {
+                continue;
+            }
+            auto device = header.substr(header.rfind('/') + 1);
+
+            auto [first, last] = monitor->devices.equal_range(device);
+            for (auto iter = first; iter != last; ++iter)
+            {
+                monitor->queue(iter->second);
+            }
+        }
+
+        return 0;
+    }
+
+    static int onInotify(sd_event_source*, int fd, uint32_t, void* userdata)
+    {
+        auto monitor = static_cast<EepromMonitor*>(userdata);
+        alignas(inotify_event) char buf[4096];
+        ssize_t len;
+
+        while ((len = read(fd, buf, sizeof(buf))) > 0)
+        {
+            for (char* ptr = buf; ptr < buf + len;)
+            {
+                auto notify = reinterpret_cast<const inotify_event*>(ptr);
+                ptr += sizeof(inotify_event) + notify->len;
+
+                auto dir = monitor->watches.find(notify->wd);
+                if (dir == monitor->watches.end() || notify->len == 0)
+                {
+                    continue;
+                }
+
+                auto [first, last] =
+                    monitor->files.equal_range(dir->second / notify->name);
+                for (auto iter = first; iter != last; ++iter)
+                {
+                    monitor->queue(iter->second);
+                }
+            }
+        }
+
+        return 0;
+    }
+
+    static int onRequest(sd_event_source*, int fd, uint32_t, void* userdata)
+    {
+        auto monitor = static_cast<EepromMonitor*>(userdata);
+        char buf[16];
+        ssize_t len;
+
+        while ((len = recv(fd, buf, sizeof(buf), 0)) > 0)
+        {
+            std::string_view request(buf, len);
+            while (!request.empty() &&
+                   std::isspace(static_cast<unsigned char>(request.back())))
+            {
+                request.remove_suffix(1);
+            }
+
+            unsigned int fruid = 0;
+            auto last = request.data() + request.size();
+            auto [end, ec] = std::from_chars(request.data(), last, fruid);
+            bool found = false;
+            if (ec == std::errc() && end == last)
+            {
+                for (size_t i = 0; i < monitor->fruFiles.size(); i++)
+                {
+                    if (monitor->fruFiles[i].first == fruid)
+                    {
+                        monitor->queue(i);
+                        found = true;
+                    }
+                }
+            }
+
+            if (!found)
+            {
+                lg2::error("Ignoring request for unknown fru id: {REQUEST}",
+                           "REQUEST", std::string(request));
+            }
+        }
+
+        return 0;
+    }
+
+    sdbusplus::bus_t& bus;
+    sd_event* event;
+    std::vector<std::pair<uint8_t, std::string>> fruFiles;
+    std::chrono::milliseconds debounce;
+
+    // Indices into fruFiles, by sysfs device name and by file name.
+    std::multimap<std::string, size_t, std::less<>> devices;
+    std::multimap<std::filesystem::path, size_t> files;
+
+    // Directories watched through inotify, by watch descriptor.
+    std::map<int, std::filesystem::path> watches;
+
+    int ueventFd = -1;
+    int inotifyFd = -1;
+    int socketFd = -1;
+
+    // The FRUs to read once the debounce timer expires.
+    std::set<size_t> pending;
+    sdbusplus::Timer debounceTimer;
+};
+
+} // namespace
+
+int monitorEeproms(std::vector<std::pair<uint8_t, std::string>> fruFiles,
+                   const std::string& socketPath,
+                   std::chrono::milliseconds debounce)
+{
+    sd_event* event = nullptr;
+    int rc = sd_event_default(&event);
+    if (rc < 0)
+    {
+        lg2::error("Unable to get the event loop, error: {ERRNO}", "ERRNO",
+                   std::strerror(-rc));
+        return -1;
+    }
+
+    // One connection for the lifetime of the monitor. Attaching it to the
+    // event loop lets it notice the inventory manager restarting.
+    auto bus = sdbusplus::bus::new_default();
+    bus.attach_event(event, SD_EVENT_PRIORITY_NORMAL);
+    addFruStatsObject(bus);
+
+    {
+        EepromMonitor monitor(bus, event, std::move(fruFiles), debounce);
+        rc = monitor.start(socketPath);
+        if (rc == 0)
+        {
+            monitor.readAll();
+            rc = sd_event_loop(event);
+        }
+    }
+
+    sd_event_unref(event);
+
+    return (rc < 0 ? -1 : 0);
+}
@@ -0,0 +1,29 @@
+#ifndef __IPMI_EEPROM_MONITOR_H__
+#define __IPMI_EEPROM_MONITOR_H__
+
+#include <chrono>
+#include <cstdint>
+#include <string>
+#include <utility>
+#include <vector>
+
+/**
+ * Publish the given FRUs, then keep publishing them again whenever their
+ * EEPROMs are added or change, without ever exiting.
+ *
+ * EEPROMs in sysfs are watched through kernel uevents for their device,
+ * any other files through inotify. A FRU ID written as text to the
+ * datagram socket at socketPath re-reads that FRU on request. Events that
+ * arrive within debounce of each other are read and published together,
+ * so each FRU is read once however many events it got.
+ *
+ * @param[in] fruFiles - the IDs and filenames of the FRUs.
+ * @param[in] socketPath - where to create the request socket.
+ * @param[in] debounce - how long to collect events before reading.
+ * @return non-zero if the monitor could not be set up or failed.
+ */
+int monitorEeproms(std::vector<std::pair<uint8_t, std::string>> fruFiles,
+                   const std::string& socketPath,
+                   std::chrono::milliseconds debounce);
+
+#endif
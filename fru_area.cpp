@@ -5,7 +5,6 @@
 #include <phosphor-logging/lg2.hpp>
 
 #include <cstdint>
-#include <cstring>
 
 IPMIFruArea::IPMIFruArea(const uint8_t fruID, const ipmi_fru_area_type type) :
     fruID(fruID), type(type)
@@ -36,9 +35,3 @@ IPMIFruArea::IPMIFruArea(const uint8_t fruID, const ipmi_fru_area_type type) :
         lg2::error("type: {TYPE} is an invalid Area", "TYPE", type);
     }
 }
-
-void IPMIFruArea::setData(const uint8_t* value, const size_t length)
-{
-    data.reserve(length); // pre-allocate the space.
-    data.insert(data.begin(), value, value + length);
-}
@@ -6,6 +6,7 @@
 
 #include <cstdint>
 #include <memory>
+#include <span>
 #include <string>
 #include <vector>
 
@@ -81,20 +82,23 @@ class IPMIFruArea
     /**
      * Returns the data portion.
      *
-     * @return pointer to data
+     * @return view of the area in the FRU image
      */
-    inline const uint8_t* getData() const
+    inline std::span<const uint8_t> getData() const
     {
-        return data.data();
+        return data;
     }
 
     /**
-     * Accepts a pointer to data and sets it in the object.
+     * Points the area at its bytes in the FRU image. Nothing is copied, so
+     * the image has to outlive the area.
      *
-     * @param[in] value - The data to copy into the FRU area
-     * @param[in] length - the number of bytes value points to
+     * @param[in] value - the area's bytes in the FRU image
      */
-    void setData(const uint8_t* value, const size_t length);
+    inline void setData(std::span<const uint8_t> value)
+    {
+        data = value;
+    }
 
   private:
     // Unique way of identifying a FRU
@@ -109,8 +113,23 @@ class IPMIFruArea
     // If a FRU is physically present.
     bool isPresent = false;
 
-    // Actual area data.
-    std::vector<uint8_t> data;
+    // Actual area data, a view into the FRU image.
+    std::span<const uint8_t> data;
 };
 
+using FruAreaVector = std::vector<std::unique_ptr<IPMIFruArea>>;
+
+/**
+ * Populates various FRU areas.
+ *
+ * @prereq : This must be called only after validating common header
+ * @param[in] fruData - pointer to the FRU bytes
+ * @param[in] dataLen - the length of the FRU data
+ * @param[in] fruAreaVec - the FRU area vector to update, areas not in the
+ *                         FRU are removed from it
+ * @return non-zero on failure
+ */
+int ipmiPopulateFruAreas(const uint8_t* fruData, const size_t dataLen,
+                         FruAreaVector& fruAreaVec);
+
 #endif
@@ -0,0 +1,273 @@
+#include "config.h"
+
+#include "fru_cache.hpp"
+
+#include <unistd.h>
+
+#include <phosphor-logging/lg2.hpp>
+
+#include <cstdio>
+#include <cstring>
+#include <filesystem>
+#include <fstream>
+#include <iterator>
+#include <string>
+#include <string_view>
+#include <type_traits>
+#include <utility>
+#include <variant>
+#include <vector>
+
+namespace
+{
+
+// Where the cache lives, empty if there is no cache.
+constexpr std::string_view cacheDir = FRU_CACHE_DIR;
+
+// Identifies a cache entry and the layout of what follows it. Bump the
+// version whenever the layout or the meaning of IPMIFruInfo changes.
+constexpr char cacheMagic[4] = {'F', 'R', 'U', 'C'};
+constexpr uint32_t cacheVersion = 2;
+
+/**
+ * FNV-1a, good enough to tell images and cache entries apart.
+ *
+ * @param[in] data - the bytes to hash
+ * @return the hash
+ */
+uint64_t hashBytes(std::span<const uint8_t> data)
+{
+    uint64_t hash = 0xcbf29ce484222325;
+    for (uint8_t byte : data)
+    {
+        hash = (hash ^ byte) * 0x100000001b3;
+    }
+    return hash;
+}
+
+/**
+ * Get the cache entry for a FRU file.
+ *
+ * @param[in] fruFilename - the filename of the FRU
+ * @return the path of the cache entry
+ */
+std::filesystem::path getCachePath(const std::string& fruFilename)
+{
+    char name[24];
+    std::snprintf(
+        name, sizeof(name), "%016llx",
+        static_cast<unsigned long long>(hashBytes(
+            {reinterpret_cast<const uint8_t*>(fruFilename.data()),
+             fruFilename.size()})));
+    return std::filesystem::path(cacheDir) / name;
+}
+
+template <typename T>
+void append(std::vector<uint8_t>& buf, T value)
+{
+    auto bytes = reinterpret_cast<const uint8_t*>(&value);
+    buf.insert(buf.end(), bytes, bytes + sizeof(value));
+}
+
+template <typename T>
+bool extract(std::span<const uint8_t>& buf, T& value)
+{
+    if (buf.size() < sizeof(value))
+    {
+        return false;
+    }
+    std::memcpy(&value, buf.data(), sizeof(value));
+    buf = buf.subspan(sizeof(value));
+    return true;
+}
+
+void appendString(std::vector<uint8_t>& buf, const std::string& str)
+{
+    append<uint32_t>(buf, str.size());
+    buf.insert(buf.end(), str.begin(), str.end());
+}
+
+bool extractString(std::span<const uint8_t>& buf, std::string& str)
+{
+    uint32_t len = 0;
+    if (!extract(buf, len) || buf.size() < len)
+    {
+        return false;
+    }
+    str.assign(buf.begin(), buf.begin() + len);
+    buf = buf.subspan(len);
+    return true;
+}
+
+void appendValue(std::vector<uint8_t>& buf, const FruValue& value)
+{
+    append<uint8_t>(buf, value.index());
+    std::visit(
+        [&buf](const auto& value) {
+            if constexpr (std::is_same_v<std::decay_t<decltype(value)>,
+                                         std::string>)
+            {
+                appendString(buf, value);
+            }
+            else
+            {
+                append(buf, value);
+            }
+        },
+        value);
+}
+
+template <size_t... Index>
+bool extractValue(std::span<const uint8_t>& buf, FruValue& value,
+                  std::index_sequence<Index...>)
+{
+    uint8_t index = 0;
+    if (!extract(buf, index))
+    {
+        return false;
+    }
+
+    // Extract the alternative whose index was stored.
+    auto extractAlternative = [&]<size_t I>() {
+        auto& alternative = value.emplace<I>();
+        if constexpr (std::is_same_v<std::decay_t<decltype(alternative)>,
+                                     std::string>)
+        {
+            return extractString(buf, alternative);
+        }
+        else
+        {
+            return extract(buf, alternative);
+        }
+    };
+
+    bool extracted = false;
+    ((index == Index &&
+      (extracted = extractAlternative.template operator()<Index>(), true)) ||
+     ...);
+    return extracted;
+}
+
+bool extractValue(std::span<const uint8_t>& buf, FruValue& value)
+{
+    return extractValue(
+        buf, value, std::make_index_sequence<std::variant_size_v<FruValue>>());
+}
+
+} // namespace
+
+bool loadCachedFru(const std::string& fruFilename,
+                   std::span<const uint8_t> fruData, IPMIFruInfo& info)
+{
+    if (cacheDir.empty())
+    {
+        return false;
+    }
+
+    std::ifstream file(getCachePath(fruFilename), std::ios::binary);
+    if (!file)
+    {
+        return false;
+    }
+    std::vector<uint8_t> entry{std::istreambuf_iterator<char>(file),
+                               std::istreambuf_iterator<char>()};
+
+    // The entry ends with a hash of everything before it.
+    uint64_t checksum = 0;
+    std::span<const uint8_t> buf = entry;
+    if (buf.size() < sizeof(checksum))
+    {
+        return false;
+    }
+    std::memcpy(&checksum, buf.data() + buf.size() - sizeof(checksum),
+                sizeof(checksum));
+    buf = buf.first(buf.size() - sizeof(checksum));
+    if (hashBytes(buf) != checksum)
+    {
+        lg2::error("Ignoring damaged FRU cache entry for {FILE}", "FILE",
+                   fruFilename);
+        return false;
+    }
+
+    char magic[sizeof(cacheMagic)];
+    uint32_t version = 0;
+    uint64_t imageHash = 0;
+    uint64_t imageLen = 0;
+    if (!extract(buf, magic) ||
+        std::memcmp(magic, cacheMagic, sizeof(magic)) != 0 ||
+        !extract(buf, version) || version != cacheVersion ||
+        !extract(buf, imageHash) || !extract(buf, imageLen) ||
+        imageLen != fruData.size() || imageHash != hashBytes(fruData))
+    {
+        return false;
+    }
+
+    IPMIFruInfo cached;
+    for (auto& [key, value] : cached)
+    {
+        if (!extractString(buf, key) || !extractValue(buf, value))
+        {
+            return false;
+        }
+    }
+    if (!buf.empty())
+    {
+        return false;
+    }
+
+    info = std::move(cached);
+    lg2::debug("FRU cache hit for {FILE}", "FILE", fruFilename);
+    return true;
+}
+
+void storeCachedFru(const std::string& fruFilename,
+                    std::span<const uint8_t> fruData, const IPMIFruInfo& info)
+{
+    if (cacheDir.empty())
+    {
+        return;
+    }
+
+    // Room for a typical entry up front, which also keeps GCC from warning
+    // about the first few appends overflowing the initial allocation.
+    std::vector<uint8_t> entry;
+    entry.reserve(4096);
+    entry.insert(entry.end(), std::begin(cacheMagic), std::end(cacheMagic));
+    append(entry, cacheVersion);
+    append<uint64_t>(entry, hashBytes(fruData));
+    append<uint64_t>(entry, fruData.size());
+    for (const auto& [key, value] : info)
+    {
+        appendString(entry, key);
+        appendValue(entry, value);
+    }
+    append(entry, hashBytes(entry));
+
+    // Write a new entry and move it over the old one, so that a reader
+    // never sees half of it.
+    std::error_code ec;
+    std::filesystem::create_directories(cacheDir, ec);
+
+    auto cachePath = getCachePath(fruFilename);
+    auto tmpPath = cachePath;
+    tmpPath += ".tmp." + std::to_string(gettid());
+    {
+        std::ofstream file(tmpPath, std::ios::binary | std::ios::trunc);
+        file.write(reinterpret_cast<const char*>(entry.data()), entry.size());
+        if (!file.flush())
+        {
+            lg2::error("Unable to write FRU cache entry {PATH}", "PATH",
+                       tmpPath.string());
+            std::filesystem::remove(tmpPath, ec);
+            return;
+        }
+    }
+
+    std::filesystem::rename(tmpPath, cachePath, ec);
+    if (ec)
+    {
+        lg2::error("Unable to write FRU cache entry {PATH}, error: {ERROR}",
+                   "PATH", cachePath.string(), "ERROR", ec.message());
+        std::filesystem::remove(tmpPath, ec);
+    }
+}
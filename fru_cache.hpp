@@ -0,0 +1,36 @@
+#ifndef __IPMI_FRU_CACHE_H__
+#define __IPMI_FRU_CACHE_H__
+
+#include "frup.hpp"
+
+#include <cstdint>
+#include <span>
+#include <string>
+
+/**
+ * Look up the parsed data of a FRU image in the on-disk cache.
+ *
+ * Entries are kept per FRU file and only hit for the exact image they were
+ * stored for. Entries that are stale, truncated or otherwise damaged are
+ * treated as misses.
+ *
+ * @param[in] fruFilename - the filename the image was read from.
+ * @param[in] fruData - the FRU image.
+ * @param[out] info - the parsed FRU data, on a hit.
+ * @return whether the cache had the parsed data for this image.
+ */
+bool loadCachedFru(const std::string& fruFilename,
+                   std::span<const uint8_t> fruData, IPMIFruInfo& info);
+
+/**
+ * Store the parsed data of a FRU image in the on-disk cache, replacing
+ * whatever was cached for the file before.
+ *
+ * @param[in] fruFilename - the filename the image was read from.
+ * @param[in] fruData - the FRU image.
+ * @param[in] info - the parsed FRU data.
+ */
+void storeCachedFru(const std::string& fruFilename,
+                    std::span<const uint8_t> fruData, const IPMIFruInfo& info);
+
+#endif
@@ -0,0 +1,20 @@
+#ifndef __IPMI_FRU_LOG_H__
+#define __IPMI_FRU_LOG_H__
+
+#include <phosphor-logging/lg2.hpp>
+
+/**
+ * lg2::debug for the parsing path, which logs several times per field.
+ * Built with -Dfru_debug_logging=false the calls, and the work of building
+ * their arguments, are compiled out. Include config.h before this.
+ */
+#define FRU_DEBUG(...)                                                         \
+    do                                                                         \
+    {                                                                          \
+        if constexpr (FRU_DEBUG_LOGGING)                                       \
+        {                                                                      \
+            lg2::debug(__VA_ARGS__);                                           \
+        }                                                                      \
+    } while (0)
+
+#endif
@@ -0,0 +1,417 @@
+#include "config.h"
+
+#include "fru_reader.hpp"
+
+#include "writefrudata.hpp"
+
+#include <fcntl.h>
+#include <unistd.h>
+
+#include <phosphor-logging/lg2.hpp>
+
+#if HAVE_LIBURING
+#include <liburing.h>
+#endif
+
+#include <algorithm>
+#include <atomic>
+#include <cerrno>
+#include <cstring>
+#include <map>
+#include <string_view>
+#include <thread>
+#include <utility>
+#include <vector>
+
+namespace
+{
+
+// Upper bound on the reader threads when io_uring is not available.
+constexpr size_t maxReaderThreads = 16;
+
+/**
+ * A read of part of a FRU image.
+ */
+struct FruRead
+{
+    size_t file;
+    size_t offset;
+    size_t length;
+
+    // Bytes read, or a negative errno.
+    ssize_t result = 0;
+};
+
+/**
+ * Get the bus a FRU file's device is on. Reads on the same bus would only
+ * queue up behind each other, so they share a thread.
+ *
+ * @param[in] fruFilename - the filename of the FRU
+ * @return a name for the bus
+ */
+std::string getBusName(const std::string& fruFilename)
+{
+    // e.g. /sys/bus/i2c/devices/3-0050/eeprom is on bus 3.
+    if (fruFilename.starts_with("/sys/"))
+    {
+        auto dirEnd = fruFilename.rfind('/');
+        auto dirStart = fruFilename.rfind('/', dirEnd - 1) + 1;
+        auto busEnd = fruFilename.find('-', dirStart);
+        if (busEnd < dirEnd)
+        {
+            return fruFilename.substr(dirStart, busEnd - dirStart);
+        }
+    }
+
+    // Anything else is not known to share anything with other files.
+    return fruFilename;
+}
+
+#if HAVE_LIBURING
+/**
+ * Cancel the reads still in flight on a ring and wait for every one of them
+ * to complete, so that none can land in the buffers once the ring is gone.
+ *
+ * @param[in] ring - the ring the reads were submitted to
+ * @param[in] inFlight - the number of reads submitted and not completed
+ */
+void cancelUringReads(io_uring& ring, unsigned inFlight)
+{
+    io_uring_sqe* sqe = io_uring_get_sqe(&ring);
+    if (sqe != nullptr)
+    {
+        io_uring_prep_cancel64(sqe, 0, IORING_ASYNC_CANCEL_ANY);
+        int submitted = io_uring_submit(&ring);
+        if (submitted > 0)
+        {
+            // The cancel completes too, along with whatever else was
+            // still queued.
+            inFlight += submitted;
+        }
+    }
+
+    // The completion queue has room for everything submitted, so each of
+    // these does complete, if only as canceled. Waiting can't be given up
+    // on, only retried.
+    while (inFlight > 0)
+    {
+        io_uring_cqe* cqe;
+        if (io_uring_wait_cqe(&ring, &cqe) < 0)
+        {
+            continue;
+        }
+        io_uring_cqe_seen(&ring, cqe);
+        inFlight--;
+    }
+}
+
+/**
+ * Perform reads through io_uring, all of them in flight at once.
+ *
+ * @param[in] fds - the open FRU files
+ * @param[in,out] reads - the reads to perform
+ * @param[in,out] fruData - the images to read into
+ * @return non-zero if io_uring can't be used
+ */
+int readWithUring(std::span<const int> fds, std::span<FruRead> reads,
+                  std::vector<std::vector<uint8_t>>& fruData)
+{
+    constexpr unsigned maxEntries = 256;
+
+    io_uring ring;
+    unsigned entries = std::min<size_t>(reads.size(), maxEntries);
+    int rc = io_uring_queue_init(entries, &ring, 0);
+    if (rc < 0)
+    {
+        lg2::debug("io_uring unavailable, error: {ERRNO}", "ERRNO",
+                   std::strerror(-rc));
+        return -1;
+    }
+
+    for (size_t first = 0; first < reads.size(); first += entries)
+    {
+        auto batch = reads.subspan(
+            first, std::min<size_t>(entries, reads.size() - first));
+        std::vector<size_t> pending(batch.size());
+        for (size_t i = 0; i < batch.size(); i++)
+        {
+            batch[i].result = 0;
+            pending[i] = i;
+        }
+
+        // Reads can come back short, a sysfs EEPROM only returns a page at
+        // a time, so resubmit the rest of them until they are complete, hit
+        // the end of the file or fail, like readWithThreads does.
+        while (!pending.empty())
+        {
+            for (size_t i : pending)
+            {
+                auto& read = batch[i];
+                io_uring_sqe* sqe = io_uring_get_sqe(&ring);
+                io_uring_prep_read(
+                    sqe, fds[read.file],
+                    fruData[read.file].data() + read.offset + read.result,
+                    read.length - read.result, read.offset + read.result);
+                io_uring_sqe_set_data64(sqe, i);
+            }
+
+            // Everything submitted has to complete before the buffers can
+            // be touched again, whatever else goes wrong.
+            std::vector<size_t> resubmit;
+            int submitted = io_uring_submit(&ring);
+            int completed = 0;
+            while (completed < submitted)
+            {
+                io_uring_cqe* cqe;
+                rc = io_uring_wait_cqe(&ring, &cqe);
+                if (rc == -EINTR)
+                {
+                    continue;
+                }
+                if (rc < 0)
+                {
+                    break;
+                }
+                size_t i = io_uring_cqe_get_data64(cqe);
+                auto& read = batch[i];
+                if (cqe->res < 0)
+                {
+                    read.result = cqe->res;
+                }
+                else if (cqe->res > 0)
+                {
+                    read.result += cqe->res;
+                    if (static_cast<size_t>(read.result) < read.length)
+                    {
+                        resubmit.push_back(i);
+                    }
+                }
+                io_uring_cqe_seen(&ring, cqe);
+                completed++;
+            }
+
+            // Let the threads do all of it instead, the reads can be
+            // repeated, but not before none of them can land in the
+            // buffers anymore.
+            if (rc < 0 || submitted < static_cast<int>(pending.size()))
+            {
+                lg2::error("io_uring reads failed, error: {ERRNO}", "ERRNO",
+                           std::strerror(submitted < 0 ? -submitted : -rc));
+                if (completed < submitted)
+                {
+                    cancelUringReads(ring, submitted - completed);
+                }
+                io_uring_queue_exit(&ring);
+                return -1;
+            }
+
+            pending = std::move(resubmit);
+        }
+    }
+
+    io_uring_queue_exit(&ring);
+    return 0;
+}
+#endif
+
+/**
+ * Perform reads with a thread per bus.
+ *
+ * @param[in] fds - the open FRU files
+ * @param[in] busNames - the bus each file is on
+ * @param[in,out] reads - the reads to perform
+ * @param[in,out] fruData - the images to read into
+ */
+void readWithThreads(std::span<const int> fds,
+                     std::span<const std::string> busNames,
+                     std::span<FruRead> reads,
+                     std::vector<std::vector<uint8_t>>& fruData)
+{
+    std::map<std::string_view, std::vector<FruRead*>> busReads;
+    for (auto& read : reads)
+    {
+        busReads[busNames[read.file]].push_back(&read);
+    }
+
+    std::vector<std::vector<FruRead*>*> queues;
+    for (auto& [bus, queue] : busReads)
+    {
+        queues.push_back(&queue);
+    }
+
+    std::atomic<size_t> next = 0;
+    auto worker = [&]() {
+        for (size_t i = next++; i < queues.size(); i = next++)
+        {
+            for (auto read : *queues[i])
+            {
+                uint8_t* buf = fruData[read->file].data() + read->offset;
+                read->result = 0;
+                while (static_cast<size_t>(read->result) < read->length)
+                {
+                    ssize_t len = pread(fds[read->file], buf + read->result,
+                                        read->length - read->result,
+                                        read->offset + read->result);
+                    if (len <= 0)
+                    {
+                        if (len < 0)
+                        {
+                            read->result = -errno;
+                        }
+                        break;
+                    }
+                    read->result += len;
+                }
+            }
+        }
+    };
+
+    size_t threadCount = std::min(queues.size(), maxReaderThreads);
+    std::vector<std::jthread> threads;
+    for (size_t i = 1; i < threadCount; i++)
+    {
+        threads.emplace_back(worker);
+    }
+    worker();
+}
+
+} // namespace
+
+std::vector<int> readFRUFiles(std::span<const std::string> fruFilenames,
+                              std::vector<std::vector<uint8_t>>& fruData)
+{
+    std::vector<int> results(fruFilenames.size(), 0);
+    std::vector<int> fds(fruFilenames.size(), -1);
+    std::vector<std::string> busNames;
+    fruData.assign(fruFilenames.size(), {});
+
+    for (size_t i = 0; i < fruFilenames.size(); i++)
+    {
+        fds[i] = open(fruFilenames[i].c_str(), O_RDONLY | O_CLOEXEC);
+        if (fds[i] < 0)
+        {
+            lg2::error("Unable to open {FILE}, error: {ERRNO}", "FILE",
+                       fruFilenames[i], "ERRNO", std::strerror(errno));
+            results[i] = -1;
+        }
+        busNames.emplace_back(getBusName(fruFilenames[i]));
+    }
+
+    // Each round reads a part of every image that still needs reading,
+    // which part depends on what the previous rounds got: first the common
+    // header, then the area headers, then the areas, and then, one round per
+    // record, the rest of the multirecord area.
+    std::vector<std::vector<bool>> have(fruFilenames.size());
+    std::vector<bool> done(fruFilenames.size(), false);
+    for (bool first = true;; first = false)
+    {
+        std::vector<FruRead> reads;
+        for (size_t i = 0; i < fruFilenames.size(); i++)
+        {
+            auto& data = fruData[i];
+            if (results[i] < 0 || done[i])
+            {
+                continue;
+            }
+
+            std::vector<std::pair<size_t, size_t>> extents;
+            if (first)
+            {
+                extents.emplace_back(0, sizeof(struct common_header));
+            }
+            else if (isBlankFruHeader(data.data(), data.size()))
+            {
+                // A part that was never programmed has nothing more to
+                // read, don't go looking for areas in it.
+                lg2::error("{FILE} is blank, common header is all {BYTE}",
+                           "FILE", fruFilenames[i], "BYTE", lg2::hex, data[0]);
+                results[i] = -1;
+                continue;
+            }
+            else
+            {
+                getFruAreaExtents(data.data(), data.size(), extents);
+            }
+
+            // Only read what hasn't been, not the gaps between areas. Areas
+            // that touch are read together.
+            std::ranges::sort(extents);
+            size_t readsBefore = reads.size();
+            for (auto [offset, length] : extents)
+            {
+                if (offset + length > data.size())
+                {
+                    data.resize(offset + length);
+                    have[i].resize(offset + length);
+                }
+                for (size_t pos = offset; pos < offset + length; pos++)
+                {
+                    if (have[i][pos])
+                    {
+                        continue;
+                    }
+                    have[i][pos] = true;
+
+                    if (reads.size() > readsBefore &&
+                        reads.back().offset + reads.back().length == pos)
+                    {
+                        reads.back().length++;
+                    }
+                    else
+                    {
+                        reads.push_back({i, pos, 1});
+                    }
+                }
+            }
+
+            // Nothing left to read means the extents were worked out from
+            // what is really in the file.
+            if (reads.size() == readsBefore)
+            {
+                done[i] = true;
+            }
+        }
+
+        if (reads.empty())
+        {
+            break;
+        }
+
+#if HAVE_LIBURING
+        if (readWithUring(fds, reads, fruData) < 0)
+#endif
+        {
+            readWithThreads(fds, busNames, reads, fruData);
+        }
+
+        // An image is only what could be read of it, any later round would
+        // just find it incomplete.
+        for (const auto& read : reads)
+        {
+            if (read.result < 0)
+            {
+                lg2::error("Failed to read {FILE}, error: {ERRNO}", "FILE",
+                           fruFilenames[read.file], "ERRNO",
+                           std::strerror(-read.result));
+                results[read.file] = -1;
+            }
+            else if (static_cast<size_t>(read.result) < read.length)
+            {
+                fruData[read.file].resize(
+                    std::min(fruData[read.file].size(),
+                             read.offset + read.result));
+                done[read.file] = true;
+            }
+        }
+    }
+
+    for (int fd : fds)
+    {
+        if (fd >= 0)
+        {
+            close(fd);
+        }
+    }
+
+    return results;
+}
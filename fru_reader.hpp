@@ -0,0 +1,28 @@
+#ifndef __IPMI_FRU_READER_H__
+#define __IPMI_FRU_READER_H__
+
+#include <cstdint>
+#include <span>
+#include <string>
+#include <vector>
+
+/**
+ * Read the FRU images in several files at once.
+ *
+ * Only the common header and the areas it references are read, the bytes
+ * between areas are left zero. All the files' headers are read together,
+ * then all their area headers, then all their areas, through io_uring where
+ * it is available and otherwise with a thread per I2C bus, so devices behind
+ * different buses are read concurrently. Files whose header is blank are
+ * not read any further and fail.
+ *
+ * @param[in] fruFilenames - the filenames of the FRUs.
+ * @param[out] fruData - the image read from each file. Images whose header
+ *                       is not valid are left at the header, for the caller
+ *                       to reject.
+ * @return non-zero, per file, for files that could not be read.
+ */
+std::vector<int> readFRUFiles(std::span<const std::string> fruFilenames,
+                              std::vector<std::vector<uint8_t>>& fruData);
+
+#endif
@@ -0,0 +1,182 @@
+#include "fru_stats.hpp"
+
+#include <systemd/sd-bus.h>
+
+#include <phosphor-logging/lg2.hpp>
+#include <sdbusplus/vtable.hpp>
+
+#include <algorithm>
+#include <array>
+#include <cstdio>
+#include <cstring>
+#include <map>
+#include <mutex>
+#include <string>
+#include <string_view>
+
+namespace
+{
+
+// Upper bounds of the histogram buckets, in microseconds. The last bucket
+// takes everything slower.
+constexpr std::array<uint64_t, 6> bucketBoundsUs = {10,     100,     1000,
+                                                    10'000, 100'000, 1'000'000};
+
+constexpr std::array<std::string_view, static_cast<size_t>(FruStage::max)>
+    stageNames = {"read",     "validate_header", "populate_areas", "parse",
+                  "map_build", "mapper_lookup",  "notify"};
+
+constexpr std::array<std::string_view, static_cast<size_t>(FruCounter::max)>
+    counterNames = {"read_bytes", "write_chunks", "write_bytes", "commits",
+                    "publish_failures"};
+
+/**
+ * How long a stage took, over every time it was done for a FRU.
+ */
+struct StageStats
+{
+    uint64_t count = 0;
+    uint64_t totalUs = 0;
+    uint64_t maxUs = 0;
+    std::array<uint64_t, bucketBoundsUs.size() + 1> buckets{};
+};
+
+/**
+ * Everything recorded for a FRU.
+ */
+struct FruStats
+{
+    std::array<StageStats, static_cast<size_t>(FruStage::max)> stages{};
+    std::array<uint64_t, static_cast<size_t>(FruCounter::max)> counters{};
+};
+
+// FRUs are parsed from several threads at once.
+std::mutex statsMutex;
+std::map<uint8_t, FruStats> fruStats;
+
+void record(uint8_t fruid, FruStage stage, uint64_t elapsedUs)
+{
+    auto& stats = fruStats[fruid].stages[static_cast<size_t>(stage)];
+    stats.count++;
+    stats.totalUs += elapsedUs;
+    stats.maxUs = std::max(stats.maxUs, elapsedUs);
+    stats.buckets[std::ranges::lower_bound(bucketBoundsUs, elapsedUs) -
+                  bucketBoundsUs.begin()]++;
+}
+
+uint64_t toUs(std::chrono::steady_clock::duration elapsed)
+{
+    return std::chrono::duration_cast<std::chrono::microseconds>(elapsed)
+        .count();
+}
+
+int dumpStats(sd_bus_message* m, void*, sd_bus_error*)
+{
+    return sd_bus_reply_method_return(m, "s", formatFruStats().c_str());
+}
+
+const sdbusplus::vtable::vtable_t statsVtable[] = {
+    sdbusplus::vtable::start(),
+    sdbusplus::vtable::method("Dump", "", "s", dumpStats,
+                              SD_BUS_VTABLE_UNPRIVILEGED),
+    sdbusplus::vtable::end(),
+};
+
+} // namespace
+
+void recordFruStage(uint8_t fruid, FruStage stage,
+                    std::chrono::steady_clock::duration elapsed)
+{
+    std::lock_guard lock(statsMutex);
+    record(fruid, stage, toUs(elapsed));
+}
+
+void recordFruStage(std::span<const uint8_t> fruids, FruStage stage,
+                    std::chrono::steady_clock::duration elapsed)
+{
+    std::lock_guard lock(statsMutex);
+    for (uint8_t fruid : fruids)
+    {
+        record(fruid, stage, toUs(elapsed));
+    }
+}
+
+void countFruEvent(uint8_t fruid, FruCounter counter, uint64_t count)
+{
+    std::lock_guard lock(statsMutex);
+    fruStats[fruid].counters[static_cast<size_t>(counter)] += count;
+}
+
+std::string formatFruStats()
+{
+    std::lock_guard lock(statsMutex);
+    std::string text = "buckets le_us";
+    char line[256];
+
+    for (uint64_t bound : bucketBoundsUs)
+    {
+        text += ' ' + std::to_string(bound);
+    }
+    text += " inf\n";
+
+    for (const auto& [fruid, stats] : fruStats)
+    {
+        for (size_t i = 0; i < stats.stages.size(); i++)
+        {
+            const auto& stage = stats.stages[i];
+            if (!stage.count)
+            {
+                continue;
+            }
+
+            // e.g. "fru 3 parse count 2 avg_us 40 max_us 52 buckets 0 2 0 ..."
+            int len = std::snprintf(
+                line, sizeof(line),
+                "fru %u %s count %llu avg_us %llu max_us %llu buckets",
+                fruid, stageNames[i].data(),
+                static_cast<unsigned long long>(stage.count),
+                static_cast<unsigned long long>(stage.totalUs / stage.count),
+                static_cast<unsigned long long>(stage.maxUs));
+            text.append(line, len);
+            for (uint64_t bucket : stage.buckets)
+            {
+                len = std::snprintf(line, sizeof(line), " %llu",
+                                    static_cast<unsigned long long>(bucket));
+                text.append(line, len);
+            }
+            text += '\n';
+        }
+
+        for (size_t i = 0; i < stats.counters.size(); i++)
+        {
+            if (!stats.counters[i])
+            {
+                continue;
+            }
+
+            int len = std::snprintf(
+                line, sizeof(line), "fru %u %s %llu\n", fruid,
+                counterNames[i].data(),
+                static_cast<unsigned long long>(stats.counters[i]));
+            text.append(line, len);
+        }
+    }
+
+    return text;
+}
+
+int addFruStatsObject(sdbusplus::bus_t& bus)
+{
+    // Without a slot, the object stays for as long as the bus does.
+    int rc = sd_bus_add_object_vtable(
+        bus.get(), nullptr, "/ipmi_fru_parser/stats", "ipmi_fru_parser.Stats",
+        statsVtable, nullptr);
+    if (rc < 0)
+    {
+        lg2::error("Unable to add FRU stats object, error: {ERRNO}", "ERRNO",
+                   std::strerror(-rc));
+        return -1;
+    }
+
+    return 0;
+}
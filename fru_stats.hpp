@@ -0,0 +1,122 @@
+#ifndef __IPMI_FRU_STATS_H__
+#define __IPMI_FRU_STATS_H__
+
+#include <sdbusplus/bus.hpp>
+
+#include <chrono>
+#include <cstdint>
+#include <span>
+#include <string>
+
+/**
+ * The stages of getting a FRU from its file, or from the host, to the
+ * inventory manager.
+ */
+enum class FruStage
+{
+    read,
+    validateHeader,
+    populateAreas,
+    parse,
+    mapBuild,
+    mapperLookup,
+    notify,
+    max,
+};
+
+/**
+ * The events counted per FRU.
+ */
+enum class FruCounter
+{
+    readBytes,
+    writeChunks,
+    writeBytes,
+    commits,
+    publishFailures,
+    max,
+};
+
+/**
+ * Account the time a stage took to a FRU.
+ *
+ * @param[in] fruid - the FRU ID.
+ * @param[in] stage - the stage.
+ * @param[in] elapsed - how long it took.
+ */
+void recordFruStage(uint8_t fruid, FruStage stage,
+                    std::chrono::steady_clock::duration elapsed);
+
+/**
+ * Account the time a stage took to each of the FRUs it was done for at once,
+ * e.g. a single call to the inventory manager for all of them.
+ *
+ * @param[in] fruids - the FRU IDs.
+ * @param[in] stage - the stage.
+ * @param[in] elapsed - how long it took.
+ */
+void recordFruStage(std::span<const uint8_t> fruids, FruStage stage,
+                    std::chrono::steady_clock::duration elapsed);
+
+/**
+ * Count events for a FRU.
+ *
+ * @param[in] fruid - the FRU ID.
+ * @param[in] counter - what happened.
+ * @param[in] count - how many times, or e.g. how many bytes.
+ */
+void countFruEvent(uint8_t fruid, FruCounter counter, uint64_t count = 1);
+
+/**
+ * Times a stage for a FRU, from construction until it goes out of scope.
+ */
+class FruStageTimer
+{
+  public:
+    FruStageTimer() = delete;
+    FruStageTimer(const FruStageTimer&) = delete;
+    FruStageTimer& operator=(const FruStageTimer&) = delete;
+    FruStageTimer(FruStageTimer&&) = delete;
+    FruStageTimer& operator=(FruStageTimer&&) = delete;
+
+    /**
+     * Start timing a stage.
+     *
+     * @param[in] fruid - the FRU ID.
+     * @param[in] stage - the stage.
+     */
+    FruStageTimer(uint8_t fruid, FruStage stage) :
+        fruid(fruid), stage(stage), start(std::chrono::steady_clock::now())
+    {}
+
+    ~FruStageTimer()
+    {
+        recordFruStage(fruid, stage, std::chrono::steady_clock::now() - start);
+    }
+
+  private:
+    uint8_t fruid;
+    FruStage stage;
+    std::chrono::steady_clock::time_point start;
+};
+
+/**
+ * Format the statistics of every FRU that has any as text, one line per
+ * stage and counter.
+ *
+ * @return the statistics.
+ */
+std::string formatFruStats();
+
+/**
+ * Serve the statistics on D-Bus for as long as the bus is open, as text
+ * returned by the Dump method of ipmi_fru_parser.Stats at
+ * /ipmi_fru_parser/stats. The interface is private to this project, it is
+ * meant for debugging and not defined in phosphor-dbus-interfaces.
+ *
+ * @param[in] bus - the bus to serve them on.
+ * @return non-zero on failure.
+ */
+int addFruStatsObject(sdbusplus::bus_t& bus);
+
+#endif
@@ -0,0 +1,28 @@
+#ifndef __IPMI_FRU_TRACE_H__
+#define __IPMI_FRU_TRACE_H__
+
+/**
+ * Static tracepoints on the FRU read, parse and publish path, for bpftrace or
+ * perf to attach to, e.g.
+ *
+ *   bpftrace -e 'usdt:/usr/lib/libwritefrudata.so:ipmi_fru_parser:*'
+ *
+ * Probes around a function come in pairs, <name>_entry and <name>_return.
+ * Probes for an event within one, e.g. populate_fru_areas_bad_area, fire on
+ * their own and have no pair. Each costs a nop while nothing is attached.
+ * Without sys/sdt.h they are compiled out and their arguments are not
+ * evaluated, so only pass values that are needed anyway. Include config.h
+ * before this.
+ */
+#if HAVE_SYS_SDT
+#include <sys/sdt.h>
+
+#define FRU_TRACE(name, ...) STAP_PROBEV(ipmi_fru_parser, name, __VA_ARGS__)
+#else
+#define FRU_TRACE(name, ...)                                                   \
+    do                                                                         \
+    {                                                                          \
+    } while (0)
+#endif
+
+#endif
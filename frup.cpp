@@ -39,8 +39,13 @@
  *  You should have received a copy of the GNU General Public License along
  *  with Ipmi-fru.  If not, see <http://www.gnu.org/licenses/>.
 \*****************************************************************************/
+#include "config.h"
+
 #include "frup.hpp"
 
+#include "fru_log.hpp"
+#include "fru_trace.hpp"
+
 #include <ctype.h>
 #include <stdio.h>
 #include <stdlib.h>
@@ -51,6 +56,11 @@
 
 #include <phosphor-logging/lg2.hpp>
 
+#include <algorithm>
+#include <array>
+#include <bit>
+#include <numeric>
+
 #define TEXTSTR(a) #a
 #define ASSERT(x)                                                              \
     do                                                                         \
@@ -65,7 +75,6 @@
         }                                                                      \
     } while (0)
 
-#define IPMI_FRU_AREA_TYPE_LENGTH_FIELD_MAX 512
 #define IPMI_FRU_SENTINEL_VALUE 0xC1
 #define IPMI_FRU_TYPE_LENGTH_TYPE_CODE_MASK 0xC0
 #define IPMI_FRU_TYPE_LENGTH_TYPE_CODE_SHIFT 0x06
@@ -83,13 +92,28 @@
 #define OPENBMC_VPD_KEY_LEN 64
 #define OPENBMC_VPD_VAL_LEN 512
 
+#define IPMI_FRU_MULTIREC_VERSION_MASK 0x0F
+#define IPMI_FRU_MULTIREC_VERSION 0x02
+
+#define IPMI_FRU_MULTIREC_POWER_SUPPLY_INFO 0x00
+#define IPMI_FRU_MULTIREC_DC_OUTPUT 0x01
+#define IPMI_FRU_MULTIREC_DC_LOAD 0x02
+#define IPMI_FRU_MULTIREC_MANAGEMENT_ACCESS 0x03
+#define IPMI_FRU_MULTIREC_MANAGEMENT_SYS_UUID 0x07
+
 constexpr long fruEpochMinutes = 820454400;
 
+/* Describes where a field's data is in the area buffer, without copying it.
+ * A zero length field is either empty or was not present in the area.
+ */
 struct ipmi_fru_field
 {
-    uint8_t type_length_field[IPMI_FRU_AREA_TYPE_LENGTH_FIELD_MAX];
-    /* store length of data stored in buffer */
-    unsigned int type_length_field_length;
+    /* offset of the field data, past the type/length byte */
+    uint16_t offset;
+    /* number of data bytes */
+    uint8_t length;
+    /* type code from the type/length byte */
+    uint8_t type_code;
 };
 
 typedef struct ipmi_fru_field ipmi_fru_field_t;
@@ -131,35 +155,133 @@ const char* vpd_key_names[] = {
     /* OPENBMC_VPD_KEY_BOARD_MFG_DATE, */ /* not a type/len */
     "Manufacturer",                       /* OPENBMC_VPD_KEY_BOARD_MFR, */
     "Name",                               /* OPENBMC_VPD_KEY_BOARD_NAME, */
-    "Serial Number",      /* OPENBMC_VPD_KEY_BOARD_SERIAL_NUM, */
-    "Part Number",        /* OPENBMC_VPD_KEY_BOARD_PART_NUM, */
-    "FRU File ID",        /* OPENBMC_VPD_KEY_BOARD_FRU_FILE_ID, */
-    "Custom Field 1",     /*OPENBMC_VPD_KEY_BOARD_CUSTOM1,*/
-    "Custom Field 2",     /*OPENBMC_VPD_KEY_BOARD_CUSTOM2,*/
-    "Custom Field 3",     /*OPENBMC_VPD_KEY_BOARD_CUSTOM3,*/
-    "Custom Field 4",     /*OPENBMC_VPD_KEY_BOARD_CUSTOM4,*/
-    "Custom Field 5",     /*OPENBMC_VPD_KEY_BOARD_CUSTOM5,*/
-    "Custom Field 6",     /*OPENBMC_VPD_KEY_BOARD_CUSTOM6,*/
-    "Custom Field 7",     /*OPENBMC_VPD_KEY_BOARD_CUSTOM7,*/
-    "Custom Field 8",     /*OPENBMC_VPD_KEY_BOARD_CUSTOM8,*/
-
-    "Manufacturer",       /* OPENBMC_VPD_KEY_PRODUCT_MFR, */
-    "Name",               /* OPENBMC_VPD_KEY_PRODUCT_NAME, */
-    "Model Number",       /* OPENBMC_VPD_KEY_PRODUCT_PART_MODEL_NUM, */
-    "Version",            /* OPENBMC_VPD_KEY_PRODUCT_VER, */
-    "Serial Number",      /* OPENBMC_VPD_KEY_PRODUCT_SERIAL_NUM, */
-    "Asset Tag",          /* OPENBMC_VPD_KEY_PRODUCT_ASSET_TAG, */
-    "FRU File ID",        /* OPENBMC_VPD_KEY_PRODUCT_FRU_FILE_ID, */
-    "Custom Field 1",     /*OPENBMC_VPD_KEY_PRODUCT_CUSTOM1,*/
-    "Custom Field 2",     /*OPENBMC_VPD_KEY_PRODUCT_CUSTOM2,*/
-    "Custom Field 3",     /*OPENBMC_VPD_KEY_PRODUCT_CUSTOM3,*/
-    "Custom Field 4",     /*OPENBMC_VPD_KEY_PRODUCT_CUSTOM4,*/
-    "Custom Field 5",     /*OPENBMC_VPD_KEY_PRODUCT_CUSTOM5,*/
-    "Custom Field 6",     /*OPENBMC_VPD_KEY_PRODUCT_CUSTOM6,*/
-    "Custom Field 7",     /*OPENBMC_VPD_KEY_PRODUCT_CUSTOM7,*/
-    "Custom Field 8",     /*OPENBMC_VPD_KEY_PRODUCT_CUSTOM8,*/
-
-    "Key Names Table End" /*OPENBMC_VPD_KEY_MAX,*/
+    "Serial Number",           /* OPENBMC_VPD_KEY_BOARD_SERIAL_NUM, */
+    "Part Number",             /* OPENBMC_VPD_KEY_BOARD_PART_NUM, */
+    "FRU File ID",             /* OPENBMC_VPD_KEY_BOARD_FRU_FILE_ID, */
+    "Custom Field 1",          /*OPENBMC_VPD_KEY_BOARD_CUSTOM1,*/
+    "Custom Field 2",          /*OPENBMC_VPD_KEY_BOARD_CUSTOM2,*/
+    "Custom Field 3",          /*OPENBMC_VPD_KEY_BOARD_CUSTOM3,*/
+    "Custom Field 4",          /*OPENBMC_VPD_KEY_BOARD_CUSTOM4,*/
+    "Custom Field 5",          /*OPENBMC_VPD_KEY_BOARD_CUSTOM5,*/
+    "Custom Field 6",          /*OPENBMC_VPD_KEY_BOARD_CUSTOM6,*/
+    "Custom Field 7",          /*OPENBMC_VPD_KEY_BOARD_CUSTOM7,*/
+    "Custom Field 8",          /*OPENBMC_VPD_KEY_BOARD_CUSTOM8,*/
+
+    "Manufacturer",            /* OPENBMC_VPD_KEY_PRODUCT_MFR, */
+    "Name",                    /* OPENBMC_VPD_KEY_PRODUCT_NAME, */
+    "Model Number",            /* OPENBMC_VPD_KEY_PRODUCT_PART_MODEL_NUM, */
+    "Version",                 /* OPENBMC_VPD_KEY_PRODUCT_VER, */
+    "Serial Number",           /* OPENBMC_VPD_KEY_PRODUCT_SERIAL_NUM, */
+    "Asset Tag",               /* OPENBMC_VPD_KEY_PRODUCT_ASSET_TAG, */
+    "FRU File ID",             /* OPENBMC_VPD_KEY_PRODUCT_FRU_FILE_ID, */
+    "Custom Field 1",          /*OPENBMC_VPD_KEY_PRODUCT_CUSTOM1,*/
+    "Custom Field 2",          /*OPENBMC_VPD_KEY_PRODUCT_CUSTOM2,*/
+    "Custom Field 3",          /*OPENBMC_VPD_KEY_PRODUCT_CUSTOM3,*/
+    "Custom Field 4",          /*OPENBMC_VPD_KEY_PRODUCT_CUSTOM4,*/
+    "Custom Field 5",          /*OPENBMC_VPD_KEY_PRODUCT_CUSTOM5,*/
+    "Custom Field 6",          /*OPENBMC_VPD_KEY_PRODUCT_CUSTOM6,*/
+    "Custom Field 7",          /*OPENBMC_VPD_KEY_PRODUCT_CUSTOM7,*/
+    "Custom Field 8",          /*OPENBMC_VPD_KEY_PRODUCT_CUSTOM8,*/
+
+    "Overall Capacity",        /* OPENBMC_VPD_KEY_PSU_CAPACITY, */
+    "Peak VA",                 /* OPENBMC_VPD_KEY_PSU_PEAK_VA, */
+    "Inrush Current",          /* OPENBMC_VPD_KEY_PSU_INRUSH_CURRENT, */
+    "Inrush Interval",         /* OPENBMC_VPD_KEY_PSU_INRUSH_INTERVAL, */
+    "Input Voltage 1 Low",     /* OPENBMC_VPD_KEY_PSU_INPUT_VOLTAGE1_LOW, */
+    "Input Voltage 1 High",    /* OPENBMC_VPD_KEY_PSU_INPUT_VOLTAGE1_HIGH, */
+    "Input Voltage 2 Low",     /* OPENBMC_VPD_KEY_PSU_INPUT_VOLTAGE2_LOW, */
+    "Input Voltage 2 High",    /* OPENBMC_VPD_KEY_PSU_INPUT_VOLTAGE2_HIGH, */
+    "Input Frequency Low",     /* OPENBMC_VPD_KEY_PSU_INPUT_FREQ_LOW, */
+    "Input Frequency High",    /* OPENBMC_VPD_KEY_PSU_INPUT_FREQ_HIGH, */
+    "AC Dropout Tolerance",    /* OPENBMC_VPD_KEY_PSU_DROPOUT_TOLERANCE, */
+    "Predictive Fail Support", /* OPENBMC_VPD_KEY_PSU_PREDICTIVE_FAIL, */
+    "Power Factor Correction", /* OPENBMC_VPD_KEY_PSU_PFC, */
+    "Autoswitch",              /* OPENBMC_VPD_KEY_PSU_AUTOSWITCH, */
+    "Hot Swap Support",        /* OPENBMC_VPD_KEY_PSU_HOT_SWAP, */
+    "Peak Capacity",           /* OPENBMC_VPD_KEY_PSU_PEAK_CAPACITY, */
+    "Hold Up Time",            /* OPENBMC_VPD_KEY_PSU_HOLD_UP_TIME, */
+    "Combined Voltage 1",      /* OPENBMC_VPD_KEY_PSU_COMBINED_VOLTAGE1, */
+    "Combined Voltage 2",      /* OPENBMC_VPD_KEY_PSU_COMBINED_VOLTAGE2, */
+    "Combined Capacity",       /* OPENBMC_VPD_KEY_PSU_COMBINED_CAPACITY, */
+    "Tachometer Threshold",    /* OPENBMC_VPD_KEY_PSU_TACH_THRESHOLD, */
+
+    "Output Number",           /* OPENBMC_VPD_KEY_DC_OUTPUT1_NUM, */
+    "Standby",                 /* OPENBMC_VPD_KEY_DC_OUTPUT1_STANDBY, */
+    "Nominal Voltage",         /* OPENBMC_VPD_KEY_DC_OUTPUT1_NOMINAL_VOLTAGE, */
+    "Max Negative Deviation",  /* OPENBMC_VPD_KEY_DC_OUTPUT1_NEG_DEVIATION, */
+    "Max Positive Deviation",  /* OPENBMC_VPD_KEY_DC_OUTPUT1_POS_DEVIATION, */
+    "Ripple And Noise",        /* OPENBMC_VPD_KEY_DC_OUTPUT1_RIPPLE, */
+    "Min Current",             /* OPENBMC_VPD_KEY_DC_OUTPUT1_MIN_CURRENT, */
+    "Max Current",             /* OPENBMC_VPD_KEY_DC_OUTPUT1_MAX_CURRENT, */
+
+    "Output Number",           /* OPENBMC_VPD_KEY_DC_OUTPUT2_NUM, */
+    "Standby",                 /* OPENBMC_VPD_KEY_DC_OUTPUT2_STANDBY, */
+    "Nominal Voltage",         /* OPENBMC_VPD_KEY_DC_OUTPUT2_NOMINAL_VOLTAGE, */
+    "Max Negative Deviation",  /* OPENBMC_VPD_KEY_DC_OUTPUT2_NEG_DEVIATION, */
+    "Max Positive Deviation",  /* OPENBMC_VPD_KEY_DC_OUTPUT2_POS_DEVIATION, */
+    "Ripple And Noise",        /* OPENBMC_VPD_KEY_DC_OUTPUT2_RIPPLE, */
+    "Min Current",             /* OPENBMC_VPD_KEY_DC_OUTPUT2_MIN_CURRENT, */
+    "Max Current",             /* OPENBMC_VPD_KEY_DC_OUTPUT2_MAX_CURRENT, */
+
+    "Output Number",           /* OPENBMC_VPD_KEY_DC_OUTPUT3_NUM, */
+    "Standby",                 /* OPENBMC_VPD_KEY_DC_OUTPUT3_STANDBY, */
+    "Nominal Voltage",         /* OPENBMC_VPD_KEY_DC_OUTPUT3_NOMINAL_VOLTAGE, */
+    "Max Negative Deviation",  /* OPENBMC_VPD_KEY_DC_OUTPUT3_NEG_DEVIATION, */
+    "Max Positive Deviation",  /* OPENBMC_VPD_KEY_DC_OUTPUT3_POS_DEVIATION, */
+    "Ripple And Noise",        /* OPENBMC_VPD_KEY_DC_OUTPUT3_RIPPLE, */
+    "Min Current",             /* OPENBMC_VPD_KEY_DC_OUTPUT3_MIN_CURRENT, */
+    "Max Current",             /* OPENBMC_VPD_KEY_DC_OUTPUT3_MAX_CURRENT, */
+
+    "Output Number",           /* OPENBMC_VPD_KEY_DC_OUTPUT4_NUM, */
+    "Standby",                 /* OPENBMC_VPD_KEY_DC_OUTPUT4_STANDBY, */
+    "Nominal Voltage",         /* OPENBMC_VPD_KEY_DC_OUTPUT4_NOMINAL_VOLTAGE, */
+    "Max Negative Deviation",  /* OPENBMC_VPD_KEY_DC_OUTPUT4_NEG_DEVIATION, */
+    "Max Positive Deviation",  /* OPENBMC_VPD_KEY_DC_OUTPUT4_POS_DEVIATION, */
+    "Ripple And Noise",        /* OPENBMC_VPD_KEY_DC_OUTPUT4_RIPPLE, */
+    "Min Current",             /* OPENBMC_VPD_KEY_DC_OUTPUT4_MIN_CURRENT, */
+    "Max Current",             /* OPENBMC_VPD_KEY_DC_OUTPUT4_MAX_CURRENT, */
+
+    "Output Number",           /* OPENBMC_VPD_KEY_DC_LOAD1_NUM, */
+    "Nominal Voltage",         /* OPENBMC_VPD_KEY_DC_LOAD1_NOMINAL_VOLTAGE, */
+    "Min Voltage",             /* OPENBMC_VPD_KEY_DC_LOAD1_MIN_VOLTAGE, */
+    "Max Voltage",             /* OPENBMC_VPD_KEY_DC_LOAD1_MAX_VOLTAGE, */
+    "Ripple And Noise",        /* OPENBMC_VPD_KEY_DC_LOAD1_RIPPLE, */
+    "Min Current",             /* OPENBMC_VPD_KEY_DC_LOAD1_MIN_CURRENT, */
+    "Max Current",             /* OPENBMC_VPD_KEY_DC_LOAD1_MAX_CURRENT, */
+
+    "Output Number",           /* OPENBMC_VPD_KEY_DC_LOAD2_NUM, */
+    "Nominal Voltage",         /* OPENBMC_VPD_KEY_DC_LOAD2_NOMINAL_VOLTAGE, */
+    "Min Voltage",             /* OPENBMC_VPD_KEY_DC_LOAD2_MIN_VOLTAGE, */
+    "Max Voltage",             /* OPENBMC_VPD_KEY_DC_LOAD2_MAX_VOLTAGE, */
+    "Ripple And Noise",        /* OPENBMC_VPD_KEY_DC_LOAD2_RIPPLE, */
+    "Min Current",             /* OPENBMC_VPD_KEY_DC_LOAD2_MIN_CURRENT, */
+    "Max Current",             /* OPENBMC_VPD_KEY_DC_LOAD2_MAX_CURRENT, */
+
+    "Output Number",           /* OPENBMC_VPD_KEY_DC_LOAD3_NUM, */
+    "Nominal Voltage",         /* OPENBMC_VPD_KEY_DC_LOAD3_NOMINAL_VOLTAGE, */
+    "Min Voltage",             /* OPENBMC_VPD_KEY_DC_LOAD3_MIN_VOLTAGE, */
+    "Max Voltage",             /* OPENBMC_VPD_KEY_DC_LOAD3_MAX_VOLTAGE, */
+    "Ripple And Noise",        /* OPENBMC_VPD_KEY_DC_LOAD3_RIPPLE, */
+    "Min Current",             /* OPENBMC_VPD_KEY_DC_LOAD3_MIN_CURRENT, */
+    "Max Current",             /* OPENBMC_VPD_KEY_DC_LOAD3_MAX_CURRENT, */
+
+    "Output Number",           /* OPENBMC_VPD_KEY_DC_LOAD4_NUM, */
+    "Nominal Voltage",         /* OPENBMC_VPD_KEY_DC_LOAD4_NOMINAL_VOLTAGE, */
+    "Min Voltage",             /* OPENBMC_VPD_KEY_DC_LOAD4_MIN_VOLTAGE, */
+    "Max Voltage",             /* OPENBMC_VPD_KEY_DC_LOAD4_MAX_VOLTAGE, */
+    "Ripple And Noise",        /* OPENBMC_VPD_KEY_DC_LOAD4_RIPPLE, */
+    "Min Current",             /* OPENBMC_VPD_KEY_DC_LOAD4_MIN_CURRENT, */
+    "Max Current",             /* OPENBMC_VPD_KEY_DC_LOAD4_MAX_CURRENT, */
+
+    "System Management URL",   /* OPENBMC_VPD_KEY_MGMT_SYS_URL, */
+    "System Name",             /* OPENBMC_VPD_KEY_MGMT_SYS_NAME, */
+    "System Ping Address",     /* OPENBMC_VPD_KEY_MGMT_SYS_PING, */
+    "Component Management URL", /* OPENBMC_VPD_KEY_MGMT_COMP_URL, */
+    "Component Name",           /* OPENBMC_VPD_KEY_MGMT_COMP_NAME, */
+    "Component Ping Address",   /* OPENBMC_VPD_KEY_MGMT_COMP_PING, */
+    "System Unique ID",         /* OPENBMC_VPD_KEY_MGMT_SYS_UUID, */
+
+    "Key Names Table End"       /*OPENBMC_VPD_KEY_MAX,*/
 };
 
 /*
@@ -186,558 +308,552 @@ static size_t _to_time_str(uint32_t mfg_date_time, char* timestr, uint32_t len)
     return s;
 }
 
-/* private method to parse type/length */
-static int _parse_type_length(const void* areabuf, unsigned int areabuflen,
-                              unsigned int current_area_offset,
-                              uint8_t* number_of_data_bytes,
-                              ipmi_fru_field_t* field)
+/* How an info area is laid out: fixed bytes, then required type/length
+ * fields in order, then custom fields up to the end-of-fields sentinel. The
+ * required fields are decoded to the VPD keys from first_key on, the custom
+ * fields to the keys right after them.
+ */
+typedef struct fru_area_layout
 {
-    const uint8_t* areabufptr = static_cast<const uint8_t*>(areabuf);
-    uint8_t type_length;
-    uint8_t type_code;
+    unsigned int prefix_len;
+    unsigned int first_key;
+    unsigned int required_fields;
+    unsigned int custom_fields;
+} fru_area_layout_t;
+
+/* Indexed by area type */
+static constexpr fru_area_layout_t info_area_layouts[] = {
+    /* IPMI_FRU_AREA_INTERNAL_USE, not an info area */
+    {0, OPENBMC_VPD_KEY_NONE, 0, 0},
+    /* Chassis type */
+    {1, OPENBMC_VPD_KEY_CHASSIS_PART_NUM, 2, OPENBMC_VPD_KEY_CUSTOM_FIELDS_MAX},
+    /* Language code, manufacturing date */
+    {4, OPENBMC_VPD_KEY_BOARD_MFR, 5, OPENBMC_VPD_KEY_CUSTOM_FIELDS_MAX},
+    /* Language code */
+    {1, OPENBMC_VPD_KEY_PRODUCT_MFR, 7, OPENBMC_VPD_KEY_CUSTOM_FIELDS_MAX},
+};
 
-    ASSERT(areabuf);
-    ASSERT(areabuflen);
-    ASSERT(number_of_data_bytes);
-
-    type_length = areabufptr[current_area_offset];
-
-    /* ipmi workaround
-     *
-     * dell p weredge r610
-     *
-     * my reading of the fru spec is that all non-custom fields are
-     * required to be listed by the vendor.  however, on this
-     * motherboard, some areas list this, indicating that there is
-     * no more data to be parsed.  so now, for "required" fields, i
-     * check to see if the type-length field is a sentinel before
-     * calling this function.
-     */
+template <uint8_t area>
+using info_area_prefix =
+    std::array<uint8_t, info_area_layouts[area].prefix_len>;
 
-    ASSERT(type_length != IPMI_FRU_SENTINEL_VALUE);
+/* Decode where the fields of an info area are, the area's layout being known
+ * at compile time. Areas that list fewer required fields than there are,
+ * ending early with the sentinel, are accepted: some vendors do. On failure
+ * the fields before the bad one are still decoded.
+ *
+ * @param[in] areabuf - the area, past the format version and length bytes
+ * @param[out] prefix - the fixed bytes, left zero if the area is too short
+ * @param[out] fields - descriptors by VPD key, only the area's are written
+ * @return non-zero if the area is malformed
+ */
+template <uint8_t area>
+static int _decode_info_area(std::span<const uint8_t> areabuf,
+                             info_area_prefix<area>& prefix,
+                             ipmi_fru_field_t* fields)
+{
+    constexpr fru_area_layout_t layout = info_area_layouts[area];
+    static_assert(layout.required_fields > 0, "not an info area");
+    static_assert(layout.first_key + layout.required_fields +
+                      layout.custom_fields <=
+                  OPENBMC_VPD_KEY_MAX);
 
-    type_code = (type_length & IPMI_FRU_TYPE_LENGTH_TYPE_CODE_MASK) >>
-                IPMI_FRU_TYPE_LENGTH_TYPE_CODE_SHIFT;
-    (*number_of_data_bytes) =
-        type_length & IPMI_FRU_TYPE_LENGTH_NUMBER_OF_DATA_BYTES_MASK;
+    const uint8_t* buf = areabuf.data();
+    const size_t len = areabuf.size();
 
-    /* special case: this shouldn't be a length of 0x01 (see type/length
-     * byte format in fru information storage definition).
+    /* Only the fixed bytes are read unchecked, every field is checked to
+     * fit as it is decoded.
      */
-    if (type_code == IPMI_FRU_TYPE_LENGTH_TYPE_CODE_LANGUAGE_CODE &&
-        (*number_of_data_bytes) == 0x01)
+    if (len < layout.prefix_len)
     {
         return (-1);
     }
+    std::copy_n(buf, layout.prefix_len, prefix.begin());
 
-    if ((current_area_offset + 1 + (*number_of_data_bytes)) > areabuflen)
+    size_t offset = layout.prefix_len;
+    for (unsigned int i = 0;
+         offset < len && buf[offset] != IPMI_FRU_SENTINEL_VALUE; i++)
     {
-        return (-1);
-    }
+        /* More custom fields than there are keys for */
+        if (i == layout.required_fields + layout.custom_fields)
+        {
+            return (-1);
+        }
 
-    if (field)
-    {
-        memset(field->type_length_field, '\0',
-               IPMI_FRU_AREA_TYPE_LENGTH_FIELD_MAX);
-        memcpy(field->type_length_field, &areabufptr[current_area_offset],
-               1 + (*number_of_data_bytes));
-        field->type_length_field_length = 1 + (*number_of_data_bytes);
+        uint8_t type_length = buf[offset];
+        uint8_t type_code =
+            (type_length & IPMI_FRU_TYPE_LENGTH_TYPE_CODE_MASK) >>
+            IPMI_FRU_TYPE_LENGTH_TYPE_CODE_SHIFT;
+        uint8_t length =
+            type_length & IPMI_FRU_TYPE_LENGTH_NUMBER_OF_DATA_BYTES_MASK;
+
+        /* special case: this shouldn't be a length of 0x01 (see type/length
+         * byte format in fru information storage definition).
+         */
+        if ((type_code == IPMI_FRU_TYPE_LENGTH_TYPE_CODE_LANGUAGE_CODE &&
+             length == 0x01) ||
+            offset + 1 + length > len)
+        {
+            return (-1);
+        }
+
+        ipmi_fru_field_t& field = fields[layout.first_key + i];
+        field.offset = offset + 1;
+        field.length = length;
+        field.type_code = type_code;
+        offset += 1 + length;
     }
 
     return (0);
 }
 
-int ipmi_fru_chassis_info_area(
-    const void* areabuf, unsigned int areabuflen, uint8_t* chassis_type,
-    ipmi_fru_field_t* chassis_part_number,
-    ipmi_fru_field_t* chassis_serial_number,
-    ipmi_fru_field_t* chassis_custom_fields,
-    unsigned int chassis_custom_fields_len)
-{
-    const uint8_t* areabufptr = static_cast<const uint8_t*>(areabuf);
-    unsigned int area_offset = 0;
-    unsigned int custom_fields_index = 0;
-    uint8_t number_of_data_bytes;
-    int rv = -1;
+/* "00" to "ff", so that each byte is converted with a single lookup */
+static constexpr auto hex_pairs = [] {
+    constexpr char digits[] = "0123456789abcdef";
+    std::array<std::array<char, 2>, 256> pairs{};
+    for (size_t i = 0; i < pairs.size(); i++)
+    {
+        pairs[i] = {digits[i >> 4], digits[i & 0xf]};
+    }
+    return pairs;
+}();
 
-    if (!areabuf || !areabuflen)
+void fru_bin_to_hex(const uint8_t* data, size_t len, std::string& out)
+{
+    /* Empty binary fields stay empty rather than becoming a bare "0x" */
+    if (len == 0)
     {
-        return (-1);
+        return;
     }
 
-    if (chassis_part_number)
-        memset(chassis_part_number, '\0', sizeof(ipmi_fru_field_t));
-    if (chassis_serial_number)
-        memset(chassis_serial_number, '\0', sizeof(ipmi_fru_field_t));
-    if (chassis_custom_fields && chassis_custom_fields_len)
-        memset(chassis_custom_fields, '\0',
-               sizeof(ipmi_fru_field_t) * chassis_custom_fields_len);
-
-    if (chassis_type)
-        (*chassis_type) = areabufptr[area_offset];
-    area_offset++;
-
-    if (areabufptr[area_offset] == IPMI_FRU_SENTINEL_VALUE)
-        goto out;
-
-    if (_parse_type_length(areabufptr, areabuflen, area_offset,
-                           &number_of_data_bytes, chassis_part_number) < 0)
-        goto cleanup;
-    area_offset += 1; /* type/length byte */
-    area_offset += number_of_data_bytes;
-
-    if (areabufptr[area_offset] == IPMI_FRU_SENTINEL_VALUE)
-        goto out;
-
-    if (_parse_type_length(areabufptr, areabuflen, area_offset,
-                           &number_of_data_bytes, chassis_serial_number) < 0)
-        goto cleanup;
-    area_offset += 1; /* type/length byte */
-    area_offset += number_of_data_bytes;
-
-    while (area_offset < areabuflen &&
-           areabufptr[area_offset] != IPMI_FRU_SENTINEL_VALUE)
+    size_t pos = out.size();
+    out.resize(pos + 2 + (len * 2));
+
+    char* dst = out.data() + pos;
+    *dst++ = '0';
+    *dst++ = 'x';
+    for (size_t i = 0; i < len; i++)
     {
-        ipmi_fru_field_t* field_ptr = nullptr;
+        memcpy(dst, hex_pairs[data[i]].data(), 2);
+        dst += 2;
+    }
+}
+
+void _append_to_dict(uint8_t vpd_key_id, const uint8_t* areabuf,
+                     const ipmi_fru_field_t& field, IPMIFruInfo& info)
+{
+    const uint8_t* vpd_key_val = areabuf + field.offset;
+    int type_code = field.type_code;
+    int vpd_val_len = field.length;
 
-        if (chassis_custom_fields && chassis_custom_fields_len)
+    switch (type_code)
+    {
+        case 0:
         {
-            if (custom_fields_index < chassis_custom_fields_len)
-                field_ptr = &chassis_custom_fields[custom_fields_index];
-            else
-            {
-                goto cleanup;
-            }
-        }
+            std::string bin_in_ascii;
+            fru_bin_to_hex(vpd_key_val, vpd_val_len, bin_in_ascii);
 
-        if (_parse_type_length(areabufptr, areabuflen, area_offset,
-                               &number_of_data_bytes, field_ptr) < 0)
-            goto cleanup;
+            FRU_DEBUG(
+                "_append_to_dict: VPD Key = [{KEY}] : Type Code = [BINARY] : Len = [{LEN}] : Val = [{VAL}]",
+                "KEY", vpd_key_names[vpd_key_id], "LEN", vpd_val_len, "VAL",
+                bin_in_ascii);
 
-        area_offset += 1; /* type/length byte */
-        area_offset += number_of_data_bytes;
-        custom_fields_index++;
-    }
+            info[vpd_key_id] = std::make_pair(vpd_key_names[vpd_key_id],
+                                              std::move(bin_in_ascii));
+            break;
+        }
 
-out:
-    rv = 0;
-cleanup:
-    return (rv);
+        case 3:
+        {
+            std::string ascii(vpd_key_val, vpd_key_val + vpd_val_len);
+            FRU_DEBUG(
+                "_append_to_dict: VPD Key = [{KEY}] : Type Code = [ASCII+Latin] : Len = [{LEN}] : Val = [{VAL}]",
+                "KEY", vpd_key_names[vpd_key_id], "LEN", vpd_val_len, "VAL",
+                ascii);
+            info[vpd_key_id] =
+                std::make_pair(vpd_key_names[vpd_key_id], std::move(ascii));
+            break;
+        }
+    }
 }
 
-int ipmi_fru_board_info_area(
-    const void* areabuf, unsigned int areabuflen, uint8_t* language_code,
-    uint32_t* mfg_date_time, ipmi_fru_field_t* board_manufacturer,
-    ipmi_fru_field_t* board_product_name, ipmi_fru_field_t* board_serial_number,
-    ipmi_fru_field_t* board_part_number, ipmi_fru_field_t* board_fru_file_id,
-    ipmi_fru_field_t* board_custom_fields, unsigned int board_custom_fields_len)
+/* How a multirecord field is encoded in its record, and what it is decoded
+ * to.
+ */
+enum multirec_field_kind
 {
-    const uint8_t* areabufptr = static_cast<const uint8_t*>(areabuf);
-    unsigned int area_offset = 0;
-    unsigned int custom_fields_index = 0;
-    uint8_t number_of_data_bytes;
-    int rv = -1;
+    MULTIREC_U8,        /* masked byte, to uint8_t */
+    MULTIREC_U16,       /* masked little endian word, to uint16_t */
+    MULTIREC_FLAG,      /* masked byte, to bool */
+    MULTIREC_MV,        /* word in 10 mV units, to uint32_t mV */
+    MULTIREC_SIGNED_MV, /* signed word in 10 mV units, to int32_t mV */
+};
+
+typedef struct multirec_field
+{
+    openbmc_vpd_key_id key;
+    uint8_t offset;
+    multirec_field_kind kind;
+    uint16_t mask;
+} multirec_field_t;
+
+/* Power Supply Information, record type 0x00 */
+static constexpr multirec_field_t psu_info_fields[] = {
+    {OPENBMC_VPD_KEY_PSU_CAPACITY, 0, MULTIREC_U16, 0x0FFF},
+    {OPENBMC_VPD_KEY_PSU_PEAK_VA, 2, MULTIREC_U16, 0xFFFF},
+    {OPENBMC_VPD_KEY_PSU_INRUSH_CURRENT, 4, MULTIREC_U8, 0xFF},
+    {OPENBMC_VPD_KEY_PSU_INRUSH_INTERVAL, 5, MULTIREC_U8, 0xFF},
+    {OPENBMC_VPD_KEY_PSU_INPUT_VOLTAGE1_LOW, 6, MULTIREC_MV, 0xFFFF},
+    {OPENBMC_VPD_KEY_PSU_INPUT_VOLTAGE1_HIGH, 8, MULTIREC_MV, 0xFFFF},
+    {OPENBMC_VPD_KEY_PSU_INPUT_VOLTAGE2_LOW, 10, MULTIREC_MV, 0xFFFF},
+    {OPENBMC_VPD_KEY_PSU_INPUT_VOLTAGE2_HIGH, 12, MULTIREC_MV, 0xFFFF},
+    {OPENBMC_VPD_KEY_PSU_INPUT_FREQ_LOW, 14, MULTIREC_U8, 0xFF},
+    {OPENBMC_VPD_KEY_PSU_INPUT_FREQ_HIGH, 15, MULTIREC_U8, 0xFF},
+    {OPENBMC_VPD_KEY_PSU_DROPOUT_TOLERANCE, 16, MULTIREC_U8, 0xFF},
+    {OPENBMC_VPD_KEY_PSU_PREDICTIVE_FAIL, 17, MULTIREC_FLAG, 0x01},
+    {OPENBMC_VPD_KEY_PSU_PFC, 17, MULTIREC_FLAG, 0x02},
+    {OPENBMC_VPD_KEY_PSU_AUTOSWITCH, 17, MULTIREC_FLAG, 0x04},
+    {OPENBMC_VPD_KEY_PSU_HOT_SWAP, 17, MULTIREC_FLAG, 0x08},
+    {OPENBMC_VPD_KEY_PSU_PEAK_CAPACITY, 18, MULTIREC_U16, 0x0FFF},
+    {OPENBMC_VPD_KEY_PSU_HOLD_UP_TIME, 18, MULTIREC_U16, 0xF000},
+    {OPENBMC_VPD_KEY_PSU_COMBINED_VOLTAGE1, 20, MULTIREC_U8, 0xF0},
+    {OPENBMC_VPD_KEY_PSU_COMBINED_VOLTAGE2, 20, MULTIREC_U8, 0x0F},
+    {OPENBMC_VPD_KEY_PSU_COMBINED_CAPACITY, 21, MULTIREC_U16, 0xFFFF},
+    {OPENBMC_VPD_KEY_PSU_TACH_THRESHOLD, 23, MULTIREC_U8, 0xFF},
+};
+
+/* DC Output, record type 0x01. The keys are those of the first record, the
+ * keys of the nth are OPENBMC_VPD_KEY_DC_OUTPUT_FIELDS * n further.
+ */
+static constexpr multirec_field_t dc_output_fields[] = {
+    {OPENBMC_VPD_KEY_DC_OUTPUT1_NUM, 0, MULTIREC_U8, 0x0F},
+    {OPENBMC_VPD_KEY_DC_OUTPUT1_STANDBY, 0, MULTIREC_FLAG, 0x80},
+    {OPENBMC_VPD_KEY_DC_OUTPUT1_NOMINAL_VOLTAGE, 1, MULTIREC_SIGNED_MV, 0xFFFF},
+    {OPENBMC_VPD_KEY_DC_OUTPUT1_NEG_DEVIATION, 3, MULTIREC_SIGNED_MV, 0xFFFF},
+    {OPENBMC_VPD_KEY_DC_OUTPUT1_POS_DEVIATION, 5, MULTIREC_SIGNED_MV, 0xFFFF},
+    {OPENBMC_VPD_KEY_DC_OUTPUT1_RIPPLE, 7, MULTIREC_U16, 0xFFFF},
+    {OPENBMC_VPD_KEY_DC_OUTPUT1_MIN_CURRENT, 9, MULTIREC_U16, 0xFFFF},
+    {OPENBMC_VPD_KEY_DC_OUTPUT1_MAX_CURRENT, 11, MULTIREC_U16, 0xFFFF},
+};
+
+/* DC Load, record type 0x02, keyed like the DC Output records */
+static constexpr multirec_field_t dc_load_fields[] = {
+    {OPENBMC_VPD_KEY_DC_LOAD1_NUM, 0, MULTIREC_U8, 0x0F},
+    {OPENBMC_VPD_KEY_DC_LOAD1_NOMINAL_VOLTAGE, 1, MULTIREC_SIGNED_MV, 0xFFFF},
+    {OPENBMC_VPD_KEY_DC_LOAD1_MIN_VOLTAGE, 3, MULTIREC_SIGNED_MV, 0xFFFF},
+    {OPENBMC_VPD_KEY_DC_LOAD1_MAX_VOLTAGE, 5, MULTIREC_SIGNED_MV, 0xFFFF},
+    {OPENBMC_VPD_KEY_DC_LOAD1_RIPPLE, 7, MULTIREC_U16, 0xFFFF},
+    {OPENBMC_VPD_KEY_DC_LOAD1_MIN_CURRENT, 9, MULTIREC_U16, 0xFFFF},
+    {OPENBMC_VPD_KEY_DC_LOAD1_MAX_CURRENT, 11, MULTIREC_U16, 0xFFFF},
+};
 
-    if (!areabuf || !areabuflen)
+static FruValue _multirec_field_default(multirec_field_kind kind)
+{
+    switch (kind)
     {
-        return (-1);
+        case MULTIREC_U8:
+            return uint8_t{0};
+        case MULTIREC_U16:
+            return uint16_t{0};
+        case MULTIREC_FLAG:
+            return false;
+        case MULTIREC_MV:
+            return uint32_t{0};
+        case MULTIREC_SIGNED_MV:
+            return int32_t{0};
     }
+    return {};
+}
 
-    if (board_manufacturer)
-        memset(board_manufacturer, '\0', sizeof(ipmi_fru_field_t));
-    if (board_product_name)
-        memset(board_product_name, '\0', sizeof(ipmi_fru_field_t));
-    if (board_serial_number)
-        memset(board_serial_number, '\0', sizeof(ipmi_fru_field_t));
-    if (board_part_number)
-        memset(board_part_number, '\0', sizeof(ipmi_fru_field_t));
-    if (board_fru_file_id)
-        memset(board_fru_file_id, '\0', sizeof(ipmi_fru_field_t));
-    if (board_custom_fields && board_custom_fields_len)
-        memset(board_custom_fields, '\0',
-               sizeof(ipmi_fru_field_t) * board_custom_fields_len);
-
-    if (language_code)
-        (*language_code) = areabufptr[area_offset];
-    area_offset++;
-
-    if (mfg_date_time)
+static FruValue _decode_multirec_field(const multirec_field_t& field,
+                                       std::span<const uint8_t> data)
+{
+    uint16_t raw = data[field.offset];
+    if (field.kind != MULTIREC_U8 && field.kind != MULTIREC_FLAG)
     {
-        unsigned int minutes = areabufptr[area_offset];
-        area_offset++;
-        minutes |= (areabufptr[area_offset] << 8);
-        area_offset++;
-        minutes |= (areabufptr[area_offset] << 16);
-        area_offset++;
-
-        /* In fru, epoch is 0:00 hrs 1/1/96 == 820454400
-         * Remove it directly and remove the time conversion.
-         */
-        (*mfg_date_time) = fruEpochMinutes + static_cast<long>(minutes) * 60;
+        raw |= data[field.offset + 1] << 8;
     }
-    else
-        area_offset += 3;
-
-    if (areabufptr[area_offset] == IPMI_FRU_SENTINEL_VALUE)
-        goto out;
-
-    if (_parse_type_length(areabufptr, areabuflen, area_offset,
-                           &number_of_data_bytes, board_manufacturer) < 0)
-        goto cleanup;
-    area_offset += 1; /* type/length byte */
-    area_offset += number_of_data_bytes;
-
-    if (areabufptr[area_offset] == IPMI_FRU_SENTINEL_VALUE)
-        goto out;
-
-    if (_parse_type_length(areabufptr, areabuflen, area_offset,
-                           &number_of_data_bytes, board_product_name) < 0)
-        goto cleanup;
-    area_offset += 1; /* type/length byte */
-    area_offset += number_of_data_bytes;
-
-    if (areabufptr[area_offset] == IPMI_FRU_SENTINEL_VALUE)
-        goto out;
-
-    if (_parse_type_length(areabufptr, areabuflen, area_offset,
-                           &number_of_data_bytes, board_serial_number) < 0)
-        goto cleanup;
-    area_offset += 1; /* type/length byte */
-    area_offset += number_of_data_bytes;
-
-    if (areabufptr[area_offset] == IPMI_FRU_SENTINEL_VALUE)
-        goto out;
-
-    if (_parse_type_length(areabufptr, areabuflen, area_offset,
-                           &number_of_data_bytes, board_part_number) < 0)
-        goto cleanup;
-    area_offset += 1; /* type/length byte */
-    area_offset += number_of_data_bytes;
-
-    if (areabufptr[area_offset] == IPMI_FRU_SENTINEL_VALUE)
-        goto out;
-
-    if (_parse_type_length(areabufptr, areabuflen, area_offset,
-                           &number_of_data_bytes, board_fru_file_id) < 0)
-        goto cleanup;
-    area_offset += 1; /* type/length byte */
-    area_offset += number_of_data_bytes;
-
-    while (area_offset < areabuflen &&
-           areabufptr[area_offset] != IPMI_FRU_SENTINEL_VALUE)
+    uint16_t value = (raw & field.mask) >> std::countr_zero(field.mask);
+
+    switch (field.kind)
     {
-        ipmi_fru_field_t* field_ptr = nullptr;
+        case MULTIREC_U8:
+            return static_cast<uint8_t>(value);
+        case MULTIREC_U16:
+            return value;
+        case MULTIREC_FLAG:
+            return value != 0;
+        case MULTIREC_MV:
+            return static_cast<uint32_t>(value) * 10;
+        case MULTIREC_SIGNED_MV:
+            return static_cast<int32_t>(static_cast<int16_t>(value)) * 10;
+    }
+    return {};
+}
 
-        if (board_custom_fields && board_custom_fields_len)
+const FruValue& vpd_key_default(openbmc_vpd_key_id key)
+{
+    static const auto defaults = [] {
+        std::array<FruValue, OPENBMC_VPD_KEY_MAX> values{};
+        for (const auto& field : psu_info_fields)
+        {
+            values[field.key] = _multirec_field_default(field.kind);
+        }
+        for (int record = 0; record < OPENBMC_VPD_KEY_DC_RECORDS_MAX; record++)
         {
-            if (custom_fields_index < board_custom_fields_len)
-                field_ptr = &board_custom_fields[custom_fields_index];
-            else
+            for (const auto& field : dc_output_fields)
+            {
+                values[field.key + record * OPENBMC_VPD_KEY_DC_OUTPUT_FIELDS] =
+                    _multirec_field_default(field.kind);
+            }
+            for (const auto& field : dc_load_fields)
             {
-                goto cleanup;
+                values[field.key + record * OPENBMC_VPD_KEY_DC_LOAD_FIELDS] =
+                    _multirec_field_default(field.kind);
             }
         }
+        return values;
+    }();
 
-        if (_parse_type_length(areabufptr, areabuflen, area_offset,
-                               &number_of_data_bytes, field_ptr) < 0)
-            goto cleanup;
-
-        area_offset += 1; /* type/length byte */
-        area_offset += number_of_data_bytes;
-        custom_fields_index++;
-    }
-
-out:
-    rv = 0;
-cleanup:
-    return (rv);
+    return defaults[key];
 }
 
-int ipmi_fru_product_info_area(
-    const void* areabuf, unsigned int areabuflen, uint8_t* language_code,
-    ipmi_fru_field_t* product_manufacturer_name, ipmi_fru_field_t* product_name,
-    ipmi_fru_field_t* product_part_model_number,
-    ipmi_fru_field_t* product_version, ipmi_fru_field_t* product_serial_number,
-    ipmi_fru_field_t* product_asset_tag, ipmi_fru_field_t* product_fru_file_id,
-    ipmi_fru_field_t* product_custom_fields,
-    unsigned int product_custom_fields_len)
+static uint8_t _sum_bytes(std::span<const uint8_t> data)
 {
-    const uint8_t* areabufptr = static_cast<const uint8_t*>(areabuf);
-    unsigned int area_offset = 0;
-    unsigned int custom_fields_index = 0;
-    uint8_t number_of_data_bytes;
-    int rv = -1;
+    return std::accumulate(data.begin(), data.end(), uint8_t{0});
+}
 
-    if (!areabuf || !areabuflen)
+int ipmi_fru_multirec_next(std::span<const uint8_t> areabuf, size_t* offset,
+                           ipmi_fru_multirec_t* rec)
+{
+    if (*offset > areabuf.size() ||
+        areabuf.size() - *offset < IPMI_FRU_MULTIREC_HDR_BYTES)
     {
+        FRU_DEBUG("Multirecord area ends before its last record, offset: "
+                  "{OFFSET}",
+                  "OFFSET", *offset);
         return (-1);
     }
 
-    if (product_manufacturer_name)
-        memset(product_manufacturer_name, '\0', sizeof(ipmi_fru_field_t));
-    if (product_name)
-        memset(product_name, '\0', sizeof(ipmi_fru_field_t));
-    if (product_part_model_number)
-        memset(product_part_model_number, '\0', sizeof(ipmi_fru_field_t));
-    if (product_version)
-        memset(product_version, '\0', sizeof(ipmi_fru_field_t));
-    if (product_serial_number)
-        memset(product_serial_number, '\0', sizeof(ipmi_fru_field_t));
-    if (product_asset_tag)
-        memset(product_asset_tag, '\0', sizeof(ipmi_fru_field_t));
-    if (product_fru_file_id)
-        memset(product_fru_file_id, '\0', sizeof(ipmi_fru_field_t));
-    if (product_custom_fields && product_custom_fields_len)
-        memset(product_custom_fields, '\0',
-               sizeof(ipmi_fru_field_t) * product_custom_fields_len);
-
-    if (language_code)
-        (*language_code) = areabufptr[area_offset];
-    area_offset++;
-
-    if (areabufptr[area_offset] == IPMI_FRU_SENTINEL_VALUE)
-        goto out;
-
-    if (_parse_type_length(areabufptr, areabuflen, area_offset,
-                           &number_of_data_bytes, product_manufacturer_name) <
-        0)
-        goto cleanup;
-    area_offset += 1; /* type/length byte */
-    area_offset += number_of_data_bytes;
-
-    if (areabufptr[area_offset] == IPMI_FRU_SENTINEL_VALUE)
-        goto out;
-
-    if (_parse_type_length(areabufptr, areabuflen, area_offset,
-                           &number_of_data_bytes, product_name) < 0)
-        goto cleanup;
-    area_offset += 1; /* type/length byte */
-    area_offset += number_of_data_bytes;
-
-    if (areabufptr[area_offset] == IPMI_FRU_SENTINEL_VALUE)
-        goto out;
-
-    if (_parse_type_length(areabufptr, areabuflen, area_offset,
-                           &number_of_data_bytes, product_part_model_number) <
-        0)
-        goto cleanup;
-    area_offset += 1; /* type/length byte */
-    area_offset += number_of_data_bytes;
-
-    if (areabufptr[area_offset] == IPMI_FRU_SENTINEL_VALUE)
-        goto out;
-
-    if (_parse_type_length(areabufptr, areabuflen, area_offset,
-                           &number_of_data_bytes, product_version) < 0)
-        goto cleanup;
-    area_offset += 1; /* type/length byte */
-    area_offset += number_of_data_bytes;
-
-    if (areabufptr[area_offset] == IPMI_FRU_SENTINEL_VALUE)
-        goto out;
-
-    if (_parse_type_length(areabufptr, areabuflen, area_offset,
-                           &number_of_data_bytes, product_serial_number) < 0)
-        goto cleanup;
-    area_offset += 1; /* type/length byte */
-    area_offset += number_of_data_bytes;
-
-    if (areabufptr[area_offset] == IPMI_FRU_SENTINEL_VALUE)
-        goto out;
-
-    if (_parse_type_length(areabufptr, areabuflen, area_offset,
-                           &number_of_data_bytes, product_asset_tag) < 0)
-        goto cleanup;
-    area_offset += 1; /* type/length byte */
-    area_offset += number_of_data_bytes;
-
-    if (areabufptr[area_offset] == IPMI_FRU_SENTINEL_VALUE)
-        goto out;
-
-    if (_parse_type_length(areabufptr, areabuflen, area_offset,
-                           &number_of_data_bytes, product_fru_file_id) < 0)
-        goto cleanup;
-
-    area_offset += 1; /* type/length byte */
-    area_offset += number_of_data_bytes;
-
-    while (area_offset < areabuflen &&
-           areabufptr[area_offset] != IPMI_FRU_SENTINEL_VALUE)
+    /* type, format, length, record checksum, header checksum */
+    auto header = areabuf.subspan(*offset, IPMI_FRU_MULTIREC_HDR_BYTES);
+    if (_sum_bytes(header) != 0)
     {
-        ipmi_fru_field_t* field_ptr = nullptr;
-
-        if (product_custom_fields && product_custom_fields_len)
-        {
-            if (custom_fields_index < product_custom_fields_len)
-                field_ptr = &product_custom_fields[custom_fields_index];
-            else
-            {
-                goto cleanup;
-            }
-        }
+        FRU_DEBUG("Multirecord header checksum mismatch, offset: {OFFSET}",
+                  "OFFSET", *offset);
+        return (-1);
+    }
 
-        if (_parse_type_length(areabufptr, areabuflen, area_offset,
-                               &number_of_data_bytes, field_ptr) < 0)
-            goto cleanup;
+    size_t len = header[2];
+    if (areabuf.size() - *offset - IPMI_FRU_MULTIREC_HDR_BYTES < len)
+    {
+        FRU_DEBUG("Multirecord area ends in a record, offset: {OFFSET}",
+                  "OFFSET", *offset);
+        return (-1);
+    }
 
-        area_offset += 1; /* type/length byte */
-        area_offset += number_of_data_bytes;
-        custom_fields_index++;
+    auto data = areabuf.subspan(*offset + IPMI_FRU_MULTIREC_HDR_BYTES, len);
+    if (static_cast<uint8_t>(_sum_bytes(data) + header[3]) != 0)
+    {
+        FRU_DEBUG("Multirecord data checksum mismatch, offset: {OFFSET}",
+                  "OFFSET", *offset);
+        return (-1);
     }
 
-out:
-    rv = 0;
-cleanup:
-    return (rv);
+    rec->type = header[0];
+    rec->version = header[1] & IPMI_FRU_MULTIREC_VERSION_MASK;
+    rec->end_of_list = header[1] & IPMI_FRU_MULTIREC_END_OF_LIST;
+    rec->data = data;
+    *offset += IPMI_FRU_MULTIREC_HDR_BYTES + len;
+
+    return 0;
 }
 
-void _append_to_dict(uint8_t vpd_key_id, uint8_t* vpd_key_val,
-                     IPMIFruInfo& info)
+static void _append_multirec_fields(std::span<const multirec_field_t> fields,
+                                    int key_offset,
+                                    std::span<const uint8_t> data,
+                                    IPMIFruInfo& info)
 {
-    int type_length = vpd_key_val[0];
-    int type_code = (type_length & IPMI_FRU_TYPE_LENGTH_TYPE_CODE_MASK) >>
-                    IPMI_FRU_TYPE_LENGTH_TYPE_CODE_SHIFT;
-    int vpd_val_len = type_length &
-                      IPMI_FRU_TYPE_LENGTH_NUMBER_OF_DATA_BYTES_MASK;
-
-    /* Needed to convert each uint8_t byte to a ascii */
-    char bin_byte[3] = {0};
-
-    /*
-     * Max number of characters needed to represent 1 unsigned byte in string
-     * is number of bytes multiplied by 2. Extra 3 for 0x and a ending '\0';
-     */
-    char bin_in_ascii_len = vpd_val_len * 2 + 3;
-
-    /* Binary converted to ascii in array */
-    char* bin_in_ascii = static_cast<char*>(malloc(bin_in_ascii_len));
+    for (const auto& field : fields)
+    {
+        /* Leave out what a short record doesn't have */
+        size_t size =
+            (field.kind == MULTIREC_U8 || field.kind == MULTIREC_FLAG) ? 1 : 2;
+        if (field.offset + size > data.size())
+        {
+            continue;
+        }
 
-    /* For reading byte from the area */
-    int val = 0;
+        int key = field.key + key_offset;
+        FRU_DEBUG("Multirecord : Appending [{KEY}]", "KEY", vpd_key_names[key]);
+        info[key] = std::make_pair(vpd_key_names[key],
+                                   _decode_multirec_field(field, data));
+    }
+}
 
-    char* bin_copy = &(static_cast<char*>(bin_in_ascii)[2]);
+static void _append_management_access(std::span<const uint8_t> data,
+                                      IPMIFruInfo& info)
+{
+    /* sub-record type, then the value */
+    if (data.empty() || data[0] < 1 ||
+        data[0] > IPMI_FRU_MULTIREC_MANAGEMENT_SYS_UUID)
+    {
+        return;
+    }
 
-    switch (type_code)
+    int key = OPENBMC_VPD_KEY_MGMT_SYS_URL + data[0] - 1;
+    std::string value;
+    if (data[0] == IPMI_FRU_MULTIREC_MANAGEMENT_SYS_UUID)
     {
-        case 0:
-            memset(bin_in_ascii, 0x0, bin_in_ascii_len);
+        fru_bin_to_hex(data.data() + 1, data.size() - 1, value);
+    }
+    else
+    {
+        value.assign(data.begin() + 1, data.end());
+    }
 
-            /* Offset 1 is where actual data starts */
-            for (val = 1; val <= vpd_val_len; val++)
-            {
-                /* 2 bytes for data and 1 for terminating '\0' */
-                snprintf(bin_byte, 3, "%02x", vpd_key_val[val]);
-
-#pragma GCC diagnostic push
-#ifdef __clang__
-#pragma clang diagnostic ignored "-Wdeprecated-declarations"
-#else
-#pragma GCC diagnostic ignored "-Wstringop-truncation"
-#endif
-                /* Its a running string so strip off the '\0' */
-                strncat(bin_copy, bin_byte, 2);
-#pragma GCC diagnostic pop
-            }
+    FRU_DEBUG("Multirecord : Appending [{KEY}] = [{VAL}]", "KEY",
+              vpd_key_names[key], "VAL", value);
+    info[key] = std::make_pair(vpd_key_names[key], std::move(value));
+}
 
-            /* We need the data represented as 0x...... */
-            if (vpd_val_len > 0)
-            {
-                memcpy(bin_in_ascii, "0x", 2);
-            }
+static int _parse_multirec_area(std::span<const uint8_t> areabuf,
+                                IPMIFruInfo& info)
+{
+    size_t offset = 0;
+    int dc_outputs = 0;
+    int dc_loads = 0;
+    ipmi_fru_multirec_t rec{};
 
-            lg2::debug(
-                "_append_to_dict: VPD Key = [{KEY}] : Type Code = [BINARY] : Len = [{LEN}] : Val = [{VAL}]",
-                "KEY", vpd_key_names[vpd_key_id], "LEN", vpd_val_len, "VAL",
-                bin_in_ascii);
+    while (!rec.end_of_list)
+    {
+        size_t record_offset = offset;
+        if (ipmi_fru_multirec_next(areabuf, &offset, &rec) < 0)
+        {
+            lg2::error("Invalid multirecord, offset: {OFFSET}", "OFFSET",
+                       record_offset);
+            return (-1);
+        }
 
-            info[vpd_key_id] =
-                std::make_pair(vpd_key_names[vpd_key_id], bin_in_ascii);
-            break;
+        /* Only the layout of version 2 records is known */
+        if (rec.version != IPMI_FRU_MULTIREC_VERSION)
+        {
+            FRU_DEBUG("Skipping multirecord, type: {TYPE}, version: {VER}",
+                      "TYPE", lg2::hex, rec.type, "VER", rec.version);
+            continue;
+        }
 
-        case 3:
-            lg2::debug(
-                "_append_to_dict: VPD Key = [{KEY}] : Type Code = [ASCII+Latin] : Len = [{LEN}] : Val = [{VAL}]",
-                "KEY", vpd_key_names[vpd_key_id], "LEN", vpd_val_len, "VAL",
-                &vpd_key_val[1]);
-            info[vpd_key_id] = std::make_pair(
-                vpd_key_names[vpd_key_id],
-                std::string(vpd_key_val + 1, vpd_key_val + 1 + type_length));
-            break;
+        switch (rec.type)
+        {
+            case IPMI_FRU_MULTIREC_POWER_SUPPLY_INFO:
+                _append_multirec_fields(psu_info_fields, 0, rec.data, info);
+                break;
+            case IPMI_FRU_MULTIREC_DC_OUTPUT:
+                if (dc_outputs < OPENBMC_VPD_KEY_DC_RECORDS_MAX)
+                {
+                    _append_multirec_fields(
+                        dc_output_fields,
+                        dc_outputs++ * OPENBMC_VPD_KEY_DC_OUTPUT_FIELDS,
+                        rec.data, info);
+                }
+                break;
+            case IPMI_FRU_MULTIREC_DC_LOAD:
+                if (dc_loads < OPENBMC_VPD_KEY_DC_RECORDS_MAX)
+                {
+                    _append_multirec_fields(
+                        dc_load_fields,
+                        dc_loads++ * OPENBMC_VPD_KEY_DC_LOAD_FIELDS, rec.data,
+                        info);
+                }
+                break;
+            case IPMI_FRU_MULTIREC_MANAGEMENT_ACCESS:
+                _append_management_access(rec.data, info);
+                break;
+            default:
+                /* OEM and other records have nothing to map to */
+                FRU_DEBUG("Skipping multirecord, type: {TYPE}", "TYPE",
+                          lg2::hex, rec.type);
+                break;
+        }
     }
 
-    if (bin_in_ascii)
-    {
-        free(bin_in_ascii);
-        bin_in_ascii = nullptr;
-    }
+    return 0;
 }
 
-int parse_fru_area(const uint8_t area, const void* msgbuf, const size_t len,
+int parse_fru_area(const uint8_t area, std::span<const uint8_t> areabuf,
                    IPMIFruInfo& info)
 {
     int rv = -1;
     int i = 0;
 
-    /* Chassis */
-    uint8_t chassis_type;
-    /* Board */
+    /* Chassis type */
+    info_area_prefix<IPMI_FRU_AREA_CHASSIS_INFO> chassis_prefix{};
+    /* Language code, manufacturing date */
+    info_area_prefix<IPMI_FRU_AREA_BOARD_INFO> board_prefix{};
     uint32_t mfg_date_time;
-    /* Product */
-    // unsigned int product_custom_fields_len;
+    /* Language code */
+    info_area_prefix<IPMI_FRU_AREA_PRODUCT_INFO> product_prefix{};
 
     // ipmi_fru_area_info_t fru_area_info [ IPMI_FRU_AREA_TYPE_MAX ];
-    ipmi_fru_field_t vpd_info[OPENBMC_VPD_KEY_MAX];
+    /* Descriptors of where each field is in msgbuf, 4 bytes apiece */
+    ipmi_fru_field_t vpd_info[OPENBMC_VPD_KEY_MAX] = {};
     char timestr[OPENBMC_VPD_VAL_LEN];
 
     // uint8_t* ipmi_fru_field_str=NULL;
     // ipmi_fru_common_hdr_t* chdr = NULL;
     // uint8_t* hdr = NULL;
 
-    ASSERT(msgbuf);
+    FRU_TRACE(parse_fru_area_entry, area, areabuf.size());
 
-    for (i = 0; i < OPENBMC_VPD_KEY_MAX; i++)
-    {
-        memset(vpd_info[i].type_length_field, '\0',
-               IPMI_FRU_AREA_TYPE_LENGTH_FIELD_MAX);
-        vpd_info[i].type_length_field_length = 0;
-    }
+    /* Skip the format version and area length bytes */
+    ASSERT(areabuf.size() >= 2);
+    const uint8_t* msgbuf = areabuf.data() + 2;
+    const size_t len = areabuf.size() - 2;
 
     switch (area)
     {
         case IPMI_FRU_AREA_CHASSIS_INFO:
-            lg2::debug("Chassis : Buf len = [{LEN}]", "LEN", len);
-            ipmi_fru_chassis_info_area(
-                static_cast<const uint8_t*>(msgbuf) + 2, len, &chassis_type,
-                &vpd_info[OPENBMC_VPD_KEY_CHASSIS_PART_NUM],
-                &vpd_info[OPENBMC_VPD_KEY_CHASSIS_SERIAL_NUM],
-                &vpd_info[OPENBMC_VPD_KEY_CHASSIS_CUSTOM1],
-                OPENBMC_VPD_KEY_CUSTOM_FIELDS_MAX);
+            FRU_DEBUG("Chassis : Buf len = [{LEN}]", "LEN", len);
+            if (_decode_info_area<IPMI_FRU_AREA_CHASSIS_INFO>(
+                    {msgbuf, len}, chassis_prefix, vpd_info) < 0)
+            {
+                lg2::error("Invalid chassis info area, length: {LEN}", "LEN",
+                           len);
+                FRU_TRACE(parse_fru_area_return, area, -1);
+                return (-1);
+            }
 
             /* Populate VPD Table */
             for (i = 1; i <= OPENBMC_VPD_KEY_CHASSIS_MAX; i++)
             {
                 if (i == OPENBMC_VPD_KEY_CHASSIS_TYPE)
                 {
-                    lg2::debug("Chassis : Appending [{KEY}] = [{TYPE}]", "KEY",
-                               vpd_key_names[i], "TYPE", chassis_type);
+                    FRU_DEBUG("Chassis : Appending [{KEY}] = [{TYPE}]", "KEY",
+                              vpd_key_names[i], "TYPE", chassis_prefix[0]);
                     info[i] = std::make_pair(vpd_key_names[i],
-                                             std::to_string(chassis_type));
+                                             std::to_string(chassis_prefix[0]));
                     continue;
                 }
-                _append_to_dict(i, vpd_info[i].type_length_field, info);
+                _append_to_dict(i, msgbuf, vpd_info[i], info);
             }
             break;
         case IPMI_FRU_AREA_BOARD_INFO:
-            lg2::debug("Board : Buf len = [{LEN}]", "LEN", len);
-            ipmi_fru_board_info_area(
-                static_cast<const uint8_t*>(msgbuf) + 2, len, nullptr,
-                &mfg_date_time, &vpd_info[OPENBMC_VPD_KEY_BOARD_MFR],
-                &vpd_info[OPENBMC_VPD_KEY_BOARD_NAME],
-                &vpd_info[OPENBMC_VPD_KEY_BOARD_SERIAL_NUM],
-                &vpd_info[OPENBMC_VPD_KEY_BOARD_PART_NUM],
-                &vpd_info[OPENBMC_VPD_KEY_BOARD_FRU_FILE_ID],
-                &vpd_info[OPENBMC_VPD_KEY_BOARD_CUSTOM1],
-                OPENBMC_VPD_KEY_CUSTOM_FIELDS_MAX);
+            FRU_DEBUG("Board : Buf len = [{LEN}]", "LEN", len);
+            if (_decode_info_area<IPMI_FRU_AREA_BOARD_INFO>(
+                    {msgbuf, len}, board_prefix, vpd_info) < 0)
+            {
+                lg2::error("Invalid board info area, length: {LEN}", "LEN",
+                           len);
+                FRU_TRACE(parse_fru_area_return, area, -1);
+                return (-1);
+            }
+
+            /* Minutes since 0:00 hrs 1/1/96, which is 820454400 in unix
+             * time.
+             */
+            mfg_date_time = board_prefix[1] | (board_prefix[2] << 8) |
+                            (board_prefix[3] << 16);
+            mfg_date_time = fruEpochMinutes + mfg_date_time * 60;
 
             /* Populate VPD Table */
             for (i = OPENBMC_VPD_KEY_BOARD_MFG_DATE;
@@ -746,41 +862,81 @@ int parse_fru_area(const uint8_t area, const void* msgbuf, const size_t len,
                 if (i == OPENBMC_VPD_KEY_BOARD_MFG_DATE)
                 {
                     _to_time_str(mfg_date_time, timestr, OPENBMC_VPD_VAL_LEN);
-                    lg2::debug("Board : Appending [{KEY}] = [{VAL}]", "KEY",
-                               vpd_key_names[i], "VAL", timestr);
+                    FRU_DEBUG("Board : Appending [{KEY}] = [{VAL}]", "KEY",
+                              vpd_key_names[i], "VAL", timestr);
                     info[i] =
                         std::make_pair(vpd_key_names[i], std::string(timestr));
                     continue;
                 }
-                _append_to_dict(i, vpd_info[i].type_length_field, info);
+                _append_to_dict(i, msgbuf, vpd_info[i], info);
             }
             break;
         case IPMI_FRU_AREA_PRODUCT_INFO:
-            lg2::debug("Product : Buf len = [{LEN}]", "LEN", len);
-            ipmi_fru_product_info_area(
-                static_cast<const uint8_t*>(msgbuf) + 2, len, nullptr,
-                &vpd_info[OPENBMC_VPD_KEY_PRODUCT_MFR],
-                &vpd_info[OPENBMC_VPD_KEY_PRODUCT_NAME],
-                &vpd_info[OPENBMC_VPD_KEY_PRODUCT_PART_MODEL_NUM],
-                &vpd_info[OPENBMC_VPD_KEY_PRODUCT_VER],
-                &vpd_info[OPENBMC_VPD_KEY_PRODUCT_SERIAL_NUM],
-                &vpd_info[OPENBMC_VPD_KEY_PRODUCT_ASSET_TAG],
-                &vpd_info[OPENBMC_VPD_KEY_PRODUCT_FRU_FILE_ID],
-                &vpd_info[OPENBMC_VPD_KEY_PRODUCT_CUSTOM1],
-                OPENBMC_VPD_KEY_CUSTOM_FIELDS_MAX);
+            FRU_DEBUG("Product : Buf len = [{LEN}]", "LEN", len);
+            if (_decode_info_area<IPMI_FRU_AREA_PRODUCT_INFO>(
+                    {msgbuf, len}, product_prefix, vpd_info) < 0)
+            {
+                lg2::error("Invalid product info area, length: {LEN}", "LEN",
+                           len);
+                FRU_TRACE(parse_fru_area_return, area, -1);
+                return (-1);
+            }
 
             for (i = OPENBMC_VPD_KEY_PRODUCT_MFR;
                  i <= OPENBMC_VPD_KEY_PRODUCT_MAX; ++i)
             {
-                _append_to_dict(i, vpd_info[i].type_length_field, info);
+                _append_to_dict(i, msgbuf, vpd_info[i], info);
+            }
+            break;
+        case IPMI_FRU_AREA_MULTI_RECORD:
+            FRU_DEBUG("Multirecord : Buf len = [{LEN}]", "LEN", areabuf.size());
+            if (_parse_multirec_area(areabuf, info) < 0)
+            {
+                FRU_TRACE(parse_fru_area_return, area, -1);
+                return (-1);
             }
             break;
         default:
-            /* TODO: Parse Multi Rec / Internal use area */
+            /* TODO: Parse Internal use area */
             break;
     }
 
-    lg2::debug("parse_fru_area : Dictionary Packing Complete");
+    FRU_DEBUG("parse_fru_area : Dictionary Packing Complete");
     rv = 0;
+    FRU_TRACE(parse_fru_area_return, area, rv);
     return (rv);
 }
+
+void clear_fru_area(const uint8_t area, IPMIFruInfo& info)
+{
+    int first = OPENBMC_VPD_KEY_NONE;
+    int last = OPENBMC_VPD_KEY_NONE;
+
+    switch (area)
+    {
+        case IPMI_FRU_AREA_CHASSIS_INFO:
+            first = OPENBMC_VPD_KEY_CHASSIS_TYPE;
+            last = OPENBMC_VPD_KEY_CHASSIS_MAX;
+            break;
+        case IPMI_FRU_AREA_BOARD_INFO:
+            first = OPENBMC_VPD_KEY_BOARD_MFG_DATE;
+            last = OPENBMC_VPD_KEY_BOARD_MAX;
+            break;
+        case IPMI_FRU_AREA_PRODUCT_INFO:
+            first = OPENBMC_VPD_KEY_PRODUCT_MFR;
+            last = OPENBMC_VPD_KEY_PRODUCT_MAX;
+            break;
+        case IPMI_FRU_AREA_MULTI_RECORD:
+            first = OPENBMC_VPD_KEY_PSU_CAPACITY;
+            last = OPENBMC_VPD_KEY_MGMT_MAX;
+            break;
+        default:
+            /* Nothing is parsed out of the internal use area */
+            return;
+    }
+
+    for (int i = first; i <= last; i++)
+    {
+        info[i] = {};
+    }
+}
@@ -4,10 +4,12 @@
 #include <systemd/sd-bus.h>
 
 #include <array>
-#include <map>
+#include <cstdint>
+#include <span>
 #include <string>
+#include <string_view>
 #include <utility>
-#include <vector>
+#include <variant>
 
 enum ipmi_fru_area_type
 {
@@ -21,6 +23,7 @@ enum ipmi_fru_area_type
 
 enum openbmc_vpd_key_id
 {
+    OPENBMC_VPD_KEY_NONE = 0, /* not mapped to any FRU field */
     OPENBMC_VPD_KEY_CHASSIS_TYPE = 1, /* not a type/len */
     OPENBMC_VPD_KEY_CHASSIS_PART_NUM,
     OPENBMC_VPD_KEY_CHASSIS_SERIAL_NUM,
@@ -69,28 +72,145 @@ enum openbmc_vpd_key_id
     OPENBMC_VPD_KEY_PRODUCT_CUSTOM8,
     OPENBMC_VPD_KEY_PRODUCT_MAX = OPENBMC_VPD_KEY_PRODUCT_CUSTOM8,
 
+    /* Power supply information record */
+    OPENBMC_VPD_KEY_PSU_CAPACITY,
+    OPENBMC_VPD_KEY_PSU_PEAK_VA,
+    OPENBMC_VPD_KEY_PSU_INRUSH_CURRENT,
+    OPENBMC_VPD_KEY_PSU_INRUSH_INTERVAL,
+    OPENBMC_VPD_KEY_PSU_INPUT_VOLTAGE1_LOW,
+    OPENBMC_VPD_KEY_PSU_INPUT_VOLTAGE1_HIGH,
+    OPENBMC_VPD_KEY_PSU_INPUT_VOLTAGE2_LOW,
+    OPENBMC_VPD_KEY_PSU_INPUT_VOLTAGE2_HIGH,
+    OPENBMC_VPD_KEY_PSU_INPUT_FREQ_LOW,
+    OPENBMC_VPD_KEY_PSU_INPUT_FREQ_HIGH,
+    OPENBMC_VPD_KEY_PSU_DROPOUT_TOLERANCE,
+    OPENBMC_VPD_KEY_PSU_PREDICTIVE_FAIL,
+    OPENBMC_VPD_KEY_PSU_PFC,
+    OPENBMC_VPD_KEY_PSU_AUTOSWITCH,
+    OPENBMC_VPD_KEY_PSU_HOT_SWAP,
+    OPENBMC_VPD_KEY_PSU_PEAK_CAPACITY,
+    OPENBMC_VPD_KEY_PSU_HOLD_UP_TIME,
+    OPENBMC_VPD_KEY_PSU_COMBINED_VOLTAGE1,
+    OPENBMC_VPD_KEY_PSU_COMBINED_VOLTAGE2,
+    OPENBMC_VPD_KEY_PSU_COMBINED_CAPACITY,
+    OPENBMC_VPD_KEY_PSU_TACH_THRESHOLD,
+    OPENBMC_VPD_KEY_PSU_MAX = OPENBMC_VPD_KEY_PSU_TACH_THRESHOLD,
+
+    /* DC output records, in the order they are in the area */
+    OPENBMC_VPD_KEY_DC_OUTPUT1_NUM,
+    OPENBMC_VPD_KEY_DC_OUTPUT1_STANDBY,
+    OPENBMC_VPD_KEY_DC_OUTPUT1_NOMINAL_VOLTAGE,
+    OPENBMC_VPD_KEY_DC_OUTPUT1_NEG_DEVIATION,
+    OPENBMC_VPD_KEY_DC_OUTPUT1_POS_DEVIATION,
+    OPENBMC_VPD_KEY_DC_OUTPUT1_RIPPLE,
+    OPENBMC_VPD_KEY_DC_OUTPUT1_MIN_CURRENT,
+    OPENBMC_VPD_KEY_DC_OUTPUT1_MAX_CURRENT,
+    OPENBMC_VPD_KEY_DC_OUTPUT2_NUM,
+    OPENBMC_VPD_KEY_DC_OUTPUT2_STANDBY,
+    OPENBMC_VPD_KEY_DC_OUTPUT2_NOMINAL_VOLTAGE,
+    OPENBMC_VPD_KEY_DC_OUTPUT2_NEG_DEVIATION,
+    OPENBMC_VPD_KEY_DC_OUTPUT2_POS_DEVIATION,
+    OPENBMC_VPD_KEY_DC_OUTPUT2_RIPPLE,
+    OPENBMC_VPD_KEY_DC_OUTPUT2_MIN_CURRENT,
+    OPENBMC_VPD_KEY_DC_OUTPUT2_MAX_CURRENT,
+    OPENBMC_VPD_KEY_DC_OUTPUT3_NUM,
+    OPENBMC_VPD_KEY_DC_OUTPUT3_STANDBY,
+    OPENBMC_VPD_KEY_DC_OUTPUT3_NOMINAL_VOLTAGE,
+    OPENBMC_VPD_KEY_DC_OUTPUT3_NEG_DEVIATION,
+    OPENBMC_VPD_KEY_DC_OUTPUT3_POS_DEVIATION,
+    OPENBMC_VPD_KEY_DC_OUTPUT3_RIPPLE,
+    OPENBMC_VPD_KEY_DC_OUTPUT3_MIN_CURRENT,
+    OPENBMC_VPD_KEY_DC_OUTPUT3_MAX_CURRENT,
+    OPENBMC_VPD_KEY_DC_OUTPUT4_NUM,
+    OPENBMC_VPD_KEY_DC_OUTPUT4_STANDBY,
+    OPENBMC_VPD_KEY_DC_OUTPUT4_NOMINAL_VOLTAGE,
+    OPENBMC_VPD_KEY_DC_OUTPUT4_NEG_DEVIATION,
+    OPENBMC_VPD_KEY_DC_OUTPUT4_POS_DEVIATION,
+    OPENBMC_VPD_KEY_DC_OUTPUT4_RIPPLE,
+    OPENBMC_VPD_KEY_DC_OUTPUT4_MIN_CURRENT,
+    OPENBMC_VPD_KEY_DC_OUTPUT4_MAX_CURRENT,
+    OPENBMC_VPD_KEY_DC_OUTPUT_MAX = OPENBMC_VPD_KEY_DC_OUTPUT4_MAX_CURRENT,
+
+    /* DC load records, in the order they are in the area */
+    OPENBMC_VPD_KEY_DC_LOAD1_NUM,
+    OPENBMC_VPD_KEY_DC_LOAD1_NOMINAL_VOLTAGE,
+    OPENBMC_VPD_KEY_DC_LOAD1_MIN_VOLTAGE,
+    OPENBMC_VPD_KEY_DC_LOAD1_MAX_VOLTAGE,
+    OPENBMC_VPD_KEY_DC_LOAD1_RIPPLE,
+    OPENBMC_VPD_KEY_DC_LOAD1_MIN_CURRENT,
+    OPENBMC_VPD_KEY_DC_LOAD1_MAX_CURRENT,
+    OPENBMC_VPD_KEY_DC_LOAD2_NUM,
+    OPENBMC_VPD_KEY_DC_LOAD2_NOMINAL_VOLTAGE,
+    OPENBMC_VPD_KEY_DC_LOAD2_MIN_VOLTAGE,
+    OPENBMC_VPD_KEY_DC_LOAD2_MAX_VOLTAGE,
+    OPENBMC_VPD_KEY_DC_LOAD2_RIPPLE,
+    OPENBMC_VPD_KEY_DC_LOAD2_MIN_CURRENT,
+    OPENBMC_VPD_KEY_DC_LOAD2_MAX_CURRENT,
+    OPENBMC_VPD_KEY_DC_LOAD3_NUM,
+    OPENBMC_VPD_KEY_DC_LOAD3_NOMINAL_VOLTAGE,
+    OPENBMC_VPD_KEY_DC_LOAD3_MIN_VOLTAGE,
+    OPENBMC_VPD_KEY_DC_LOAD3_MAX_VOLTAGE,
+    OPENBMC_VPD_KEY_DC_LOAD3_RIPPLE,
+    OPENBMC_VPD_KEY_DC_LOAD3_MIN_CURRENT,
+    OPENBMC_VPD_KEY_DC_LOAD3_MAX_CURRENT,
+    OPENBMC_VPD_KEY_DC_LOAD4_NUM,
+    OPENBMC_VPD_KEY_DC_LOAD4_NOMINAL_VOLTAGE,
+    OPENBMC_VPD_KEY_DC_LOAD4_MIN_VOLTAGE,
+    OPENBMC_VPD_KEY_DC_LOAD4_MAX_VOLTAGE,
+    OPENBMC_VPD_KEY_DC_LOAD4_RIPPLE,
+    OPENBMC_VPD_KEY_DC_LOAD4_MIN_CURRENT,
+    OPENBMC_VPD_KEY_DC_LOAD4_MAX_CURRENT,
+    OPENBMC_VPD_KEY_DC_LOAD_MAX = OPENBMC_VPD_KEY_DC_LOAD4_MAX_CURRENT,
+
+    /* Management access records, text */
+    OPENBMC_VPD_KEY_MGMT_SYS_URL,
+    OPENBMC_VPD_KEY_MGMT_SYS_NAME,
+    OPENBMC_VPD_KEY_MGMT_SYS_PING,
+    OPENBMC_VPD_KEY_MGMT_COMP_URL,
+    OPENBMC_VPD_KEY_MGMT_COMP_NAME,
+    OPENBMC_VPD_KEY_MGMT_COMP_PING,
+    OPENBMC_VPD_KEY_MGMT_SYS_UUID,
+    OPENBMC_VPD_KEY_MGMT_MAX = OPENBMC_VPD_KEY_MGMT_SYS_UUID,
+
     OPENBMC_VPD_KEY_MAX,
     OPENBMC_VPD_KEY_CUSTOM_FIELDS_MAX = 8,
+    OPENBMC_VPD_KEY_DC_RECORDS_MAX = 4,
+    /* keys between a DC output or load record and the next one */
+    OPENBMC_VPD_KEY_DC_OUTPUT_FIELDS =
+        OPENBMC_VPD_KEY_DC_OUTPUT2_NUM - OPENBMC_VPD_KEY_DC_OUTPUT1_NUM,
+    OPENBMC_VPD_KEY_DC_LOAD_FIELDS =
+        OPENBMC_VPD_KEY_DC_LOAD2_NUM - OPENBMC_VPD_KEY_DC_LOAD1_NUM,
 
 };
 
+// Info area fields are text, multirecord area fields are mostly numbers.
+// Every alternative is also one of ipmi::vpd::Value's.
+using FruValue =
+    std::variant<std::string, bool, uint8_t, uint16_t, uint32_t, int32_t>;
+
 using IPMIFruInfo =
-    std::array<std::pair<std::string, std::string>, OPENBMC_VPD_KEY_MAX>;
+    std::array<std::pair<std::string, FruValue>, OPENBMC_VPD_KEY_MAX>;
 
+// The FRU mapping tables are generated from the FRU YAML as constant
+// initialized arrays, so they only refer to string literals and to each
+// other. The IPMI section and property names in the YAML are resolved to
+// the key the parser stores that field under when the tables are generated.
 struct IPMIFruData
 {
-    std::string section;
-    std::string property;
-    std::string delimiter;
+    openbmc_vpd_key_id key;
+    // Custom fields holding "key<delimiter>value" only publish the value.
+    // '\0' if the field is published as is.
+    char delimiter;
 };
 
-using DbusProperty = std::string;
-using DbusPropertyVec = std::vector<std::pair<DbusProperty, IPMIFruData>>;
+using DbusProperty = std::string_view;
+using DbusPropertyVec = std::span<const std::pair<DbusProperty, IPMIFruData>>;
 
-using DbusInterface = std::string;
-using DbusInterfaceVec = std::vector<std::pair<DbusInterface, DbusPropertyVec>>;
+using DbusInterface = std::string_view;
+using DbusInterfaceVec =
+    std::span<const std::pair<DbusInterface, DbusPropertyVec>>;
 
-using FruInstancePath = std::string;
+using FruInstancePath = std::string_view;
 
 struct FruInstance
 {
@@ -100,16 +220,51 @@ struct FruInstance
     DbusInterfaceVec interfaces;
 };
 
-using FruInstanceVec = std::vector<FruInstance>;
+using FruInstanceVec = std::span<const FruInstance>;
 
 using FruId = uint32_t;
-using FruMap = std::map<FruId, FruInstanceVec>;
+// Indexed by FRU ID. IDs without any instances map to an empty span.
+using FruMap = std::span<const FruInstanceVec>;
 
 /* Parse an IPMI write fru data message into a dictionary containing name value
  * pair of VPD entries.*/
 int parse_fru(const void* msgbuf, sd_bus_message* vpdtbl);
 
-int parse_fru_area(const uint8_t area, const void* msgbuf, const size_t len,
+/* Append the 0x prefixed, lower case hex representation of a binary FRU
+ * field to out. Nothing is appended for an empty field.*/
+void fru_bin_to_hex(const uint8_t* data, size_t len, std::string& out);
+
+/* The value of a field that is not in the FRU, which is an empty string for
+ * text fields and zero for numeric ones.*/
+const FruValue& vpd_key_default(openbmc_vpd_key_id key);
+
+/* Multirecord area record header, shared by the parser and the code that
+ * works out how far the area extends.*/
+#define IPMI_FRU_MULTIREC_HDR_BYTES 5
+#define IPMI_FRU_MULTIREC_END_OF_LIST 0x80
+
+/* A record of a multirecord area. data points into the area buffer.*/
+typedef struct ipmi_fru_multirec
+{
+    uint8_t type;
+    uint8_t version;
+    bool end_of_list;
+    std::span<const uint8_t> data;
+} ipmi_fru_multirec_t;
+
+/* Read the record at *offset into a multirecord area, checking its header
+ * and data checksums, and advance *offset past it. Records are read one at a
+ * time up to the one with end_of_list set.*/
+int ipmi_fru_multirec_next(std::span<const uint8_t> areabuf, size_t* offset,
+                           ipmi_fru_multirec_t* rec);
+
+/* Parse one FRU area into the dictionary. The fields are read straight out
+ * of areabuf, which only has to stay valid for the duration of the call.*/
+int parse_fru_area(const uint8_t area, std::span<const uint8_t> areabuf,
                    IPMIFruInfo& info);
 
+/* Reset the entries of the dictionary that an area is parsed into, as if
+ * the FRU didn't have the area. Parsing a changed area again starts here.*/
+void clear_fru_area(const uint8_t area, IPMIFruInfo& info);
+
 #endif
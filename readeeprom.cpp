@@ -1,14 +1,74 @@
+#include "eeprom_monitor.hpp"
+#include "fru_stats.hpp"
 #include "writefrudata.hpp"
 
 #include <CLI/CLI.hpp>
-#include <phosphor-logging/log.hpp>
+#include <phosphor-logging/lg2.hpp>
 
+#include <charconv>
+#include <chrono>
 #include <cstdlib>
 #include <cstring>
+#include <fstream>
 #include <iostream>
 #include <memory>
+#include <sstream>
+#include <string>
+#include <utility>
+#include <vector>
 
-using namespace phosphor::logging;
+namespace
+{
+
+const int MAX_FRU_ID = 0xfe;
+
+/**
+ * Read the FRU IDs and EEPROM files listed in a manifest. Each line holds a
+ * FRU ID and the absolute file name of its EEPROM, separated by whitespace.
+ * Empty lines and lines starting with '#' are ignored.
+ *
+ * @param[in] manifest - the file name of the manifest
+ * @param[out] fruFiles - the FRU IDs and file names to append to
+ * @return non-zero on failure
+ */
+int readManifest(const std::string& manifest,
+                 std::vector<std::pair<uint8_t, std::string>>& fruFiles)
+{
+    std::ifstream file(manifest);
+    if (!file)
+    {
+        lg2::error("Unable to open {FILE}", "FILE", manifest);
+        return -1;
+    }
+
+    std::string line;
+    for (size_t lineNum = 1; std::getline(file, line); lineNum++)
+    {
+        std::istringstream fields(line);
+        std::string first;
+        if (!(fields >> first) || first.starts_with('#'))
+        {
+            continue;
+        }
+
+        int fruid = -1;
+        std::string eeprom_file;
+        auto [end, ec] = std::from_chars(first.data(),
+                                         first.data() + first.size(), fruid);
+        if (ec != std::errc() || end != first.data() + first.size() ||
+            fruid < 0 || fruid > MAX_FRU_ID || !(fields >> eeprom_file))
+        {
+            lg2::error("Invalid entry in {FILE} at line {LINE}", "FILE",
+                       manifest, "LINE", lineNum);
+            return -1;
+        }
+        fruFiles.emplace_back(fruid, std::move(eeprom_file));
+    }
+
+    return 0;
+}
+
+} // namespace
 
 //--------------------------------------------------------------------------
 // This gets called by udev monitor soon after seeing hog plugs for EEPROMS.
@@ -16,23 +76,75 @@ using namespace phosphor::logging;
 int main(int argc, char** argv)
 {
     int rc = 0;
-    uint8_t fruid;
-    std::string eeprom_file;
-    const int MAX_FRU_ID = 0xfe;
+    std::vector<uint8_t> fruids;
+    std::vector<std::string> eeprom_files;
+    std::string manifest;
+    bool daemon = false;
+    bool stats = false;
+    std::string socketPath = "/run/phosphor-read-eeprom.sock";
+    unsigned int debounceMs = 250;
 
     CLI::App app{"OpenBMC IPMI-FRU-Parser"};
-    app.add_option("-e,--eeprom", eeprom_file, "Absolute file name of eeprom")
+    app.add_option("-e,--eeprom", eeprom_files,
+                   "Absolute file name of eeprom, may be repeated")
         ->check(CLI::ExistingFile);
-    app.add_option("-f,--fruid", fruid, "valid fru id in integer")
+    app.add_option("-f,--fruid", fruids,
+                   "valid fru id in integer, one per --eeprom")
         ->check(CLI::Range(0, MAX_FRU_ID));
+    app.add_option("-m,--manifest", manifest,
+                   "File listing a fru id and an eeprom file name per line")
+        ->check(CLI::ExistingFile);
+    app.add_flag("-d,--daemon", daemon,
+                 "Keep running and read the eeproms again when they change");
+    app.add_option("-s,--socket", socketPath,
+                   "Socket to take fru ids to read again from, in daemon mode");
+    app.add_option("--debounce", debounceMs,
+                   "Milliseconds to collect eeprom events for, in daemon mode");
+    app.add_flag("--stats", stats,
+                 "Print how long each stage took per fru id when done");
 
     // Read the arguments.
     CLI11_PARSE(app, argc, argv);
 
-    // Now that we have the file that contains the eeprom data, go read it
-    // and update the Inventory DB.
+    if (fruids.size() != eeprom_files.size())
+    {
+        std::cerr << "Every --eeprom needs a matching --fruid\n";
+        return EXIT_FAILURE;
+    }
+
+    std::vector<std::pair<uint8_t, std::string>> fruFiles;
+    for (size_t i = 0; i < fruids.size(); i++)
+    {
+        fruFiles.emplace_back(fruids[i], std::move(eeprom_files[i]));
+    }
+
+    if (!manifest.empty() && readManifest(manifest, fruFiles) < 0)
+    {
+        return EXIT_FAILURE;
+    }
+
+    if (fruFiles.empty())
+    {
+        std::cerr << "Give --eeprom and --fruid, or --manifest\n";
+        return EXIT_FAILURE;
+    }
+
+    if (daemon)
+    {
+        rc = monitorEeproms(std::move(fruFiles), socketPath,
+                            std::chrono::milliseconds(debounceMs));
+        return (rc < 0 ? EXIT_FAILURE : EXIT_SUCCESS);
+    }
+
+    // Now that we have the files that contain the eeprom data, go read them
+    // and update the Inventory DB with all of them at once.
     auto bus = sdbusplus::bus::new_default();
-    rc = validateFRUArea(fruid, eeprom_file.c_str(), bus);
+    rc = validateFRUAreas(fruFiles, bus);
+
+    if (stats)
+    {
+        std::cout << formatFruStats();
+    }
 
     return (rc < 0 ? EXIT_FAILURE : EXIT_SUCCESS);
 }
@@ -8,12 +8,161 @@ import yaml
 from mako.template import Template
 
 
+def custom_fields(prefix):
+    return {
+        "Custom Field %d" % i: "%s_CUSTOM%d" % (prefix, i) for i in range(1, 9)
+    }
+
+
+def dc_record_fields(prefix, fields):
+    return {
+        "%s %d" % (prefix, record): {
+            name: "OPENBMC_VPD_KEY_%s%d_%s"
+            % (prefix.upper().replace(" ", "_"), record, key)
+            for name, key in fields.items()
+        }
+        for record in range(1, 5)
+    }
+
+
+# Names of the FRU fields per section, as they appear in the YAML, and the
+# openbmc_vpd_key_id (see frup.hpp) the parser stores each of them under.
+vpd_keys = {
+    "Chassis": {
+        "Type": "OPENBMC_VPD_KEY_CHASSIS_TYPE",
+        "Part Number": "OPENBMC_VPD_KEY_CHASSIS_PART_NUM",
+        "Serial Number": "OPENBMC_VPD_KEY_CHASSIS_SERIAL_NUM",
+        **custom_fields("OPENBMC_VPD_KEY_CHASSIS"),
+    },
+    "Board": {
+        "Mfg Date": "OPENBMC_VPD_KEY_BOARD_MFG_DATE",
+        "Manufacturer": "OPENBMC_VPD_KEY_BOARD_MFR",
+        "Name": "OPENBMC_VPD_KEY_BOARD_NAME",
+        "Serial Number": "OPENBMC_VPD_KEY_BOARD_SERIAL_NUM",
+        "Part Number": "OPENBMC_VPD_KEY_BOARD_PART_NUM",
+        "FRU File ID": "OPENBMC_VPD_KEY_BOARD_FRU_FILE_ID",
+        **custom_fields("OPENBMC_VPD_KEY_BOARD"),
+    },
+    "Product": {
+        "Manufacturer": "OPENBMC_VPD_KEY_PRODUCT_MFR",
+        "Name": "OPENBMC_VPD_KEY_PRODUCT_NAME",
+        "Model Number": "OPENBMC_VPD_KEY_PRODUCT_PART_MODEL_NUM",
+        "Version": "OPENBMC_VPD_KEY_PRODUCT_VER",
+        "Serial Number": "OPENBMC_VPD_KEY_PRODUCT_SERIAL_NUM",
+        "Asset Tag": "OPENBMC_VPD_KEY_PRODUCT_ASSET_TAG",
+        "FRU File ID": "OPENBMC_VPD_KEY_PRODUCT_FRU_FILE_ID",
+        **custom_fields("OPENBMC_VPD_KEY_PRODUCT"),
+    },
+    # Multirecord area records. DC Output and DC Load records are numbered
+    # in the order they appear in the area.
+    "Power Supply": {
+        "Overall Capacity": "OPENBMC_VPD_KEY_PSU_CAPACITY",
+        "Peak VA": "OPENBMC_VPD_KEY_PSU_PEAK_VA",
+        "Inrush Current": "OPENBMC_VPD_KEY_PSU_INRUSH_CURRENT",
+        "Inrush Interval": "OPENBMC_VPD_KEY_PSU_INRUSH_INTERVAL",
+        "Input Voltage 1 Low": "OPENBMC_VPD_KEY_PSU_INPUT_VOLTAGE1_LOW",
+        "Input Voltage 1 High": "OPENBMC_VPD_KEY_PSU_INPUT_VOLTAGE1_HIGH",
+        "Input Voltage 2 Low": "OPENBMC_VPD_KEY_PSU_INPUT_VOLTAGE2_LOW",
+        "Input Voltage 2 High": "OPENBMC_VPD_KEY_PSU_INPUT_VOLTAGE2_HIGH",
+        "Input Frequency Low": "OPENBMC_VPD_KEY_PSU_INPUT_FREQ_LOW",
+        "Input Frequency High": "OPENBMC_VPD_KEY_PSU_INPUT_FREQ_HIGH",
+        "AC Dropout Tolerance": "OPENBMC_VPD_KEY_PSU_DROPOUT_TOLERANCE",
+        "Predictive Fail Support": "OPENBMC_VPD_KEY_PSU_PREDICTIVE_FAIL",
+        "Power Factor Correction": "OPENBMC_VPD_KEY_PSU_PFC",
+        "Autoswitch": "OPENBMC_VPD_KEY_PSU_AUTOSWITCH",
+        "Hot Swap Support": "OPENBMC_VPD_KEY_PSU_HOT_SWAP",
+        "Peak Capacity": "OPENBMC_VPD_KEY_PSU_PEAK_CAPACITY",
+        "Hold Up Time": "OPENBMC_VPD_KEY_PSU_HOLD_UP_TIME",
+        "Combined Voltage 1": "OPENBMC_VPD_KEY_PSU_COMBINED_VOLTAGE1",
+        "Combined Voltage 2": "OPENBMC_VPD_KEY_PSU_COMBINED_VOLTAGE2",
+        "Combined Capacity": "OPENBMC_VPD_KEY_PSU_COMBINED_CAPACITY",
+        "Tachometer Threshold": "OPENBMC_VPD_KEY_PSU_TACH_THRESHOLD",
+    },
+    **dc_record_fields(
+        "DC Output",
+        {
+            "Output Number": "NUM",
+            "Standby": "STANDBY",
+            "Nominal Voltage": "NOMINAL_VOLTAGE",
+            "Max Negative Deviation": "NEG_DEVIATION",
+            "Max Positive Deviation": "POS_DEVIATION",
+            "Ripple And Noise": "RIPPLE",
+            "Min Current": "MIN_CURRENT",
+            "Max Current": "MAX_CURRENT",
+        },
+    ),
+    **dc_record_fields(
+        "DC Load",
+        {
+            "Output Number": "NUM",
+            "Nominal Voltage": "NOMINAL_VOLTAGE",
+            "Min Voltage": "MIN_VOLTAGE",
+            "Max Voltage": "MAX_VOLTAGE",
+            "Ripple And Noise": "RIPPLE",
+            "Min Current": "MIN_CURRENT",
+            "Max Current": "MAX_CURRENT",
+        },
+    ),
+    "Management Access": {
+        "System Management URL": "OPENBMC_VPD_KEY_MGMT_SYS_URL",
+        "System Name": "OPENBMC_VPD_KEY_MGMT_SYS_NAME",
+        "System Ping Address": "OPENBMC_VPD_KEY_MGMT_SYS_PING",
+        "Component Management URL": "OPENBMC_VPD_KEY_MGMT_COMP_URL",
+        "Component Name": "OPENBMC_VPD_KEY_MGMT_COMP_NAME",
+        "Component Ping Address": "OPENBMC_VPD_KEY_MGMT_COMP_PING",
+        "System Unique ID": "OPENBMC_VPD_KEY_MGMT_SYS_UUID",
+    },
+}
+
+
+def resolve_vpd_key(where, property_value):
+    """Resolve the IPMI FRU section and property a D-Bus property is mapped
+    to into the key the parser stores it under, and the delimiter to apply
+    to it, as C++ expressions."""
+    section = property_value.get("IPMIFruSection")
+    name = property_value.get("IPMIFruProperty")
+    if not section and not name:
+        return "OPENBMC_VPD_KEY_NONE", "'\\x00'"
+
+    if section not in vpd_keys:
+        sys.exit("%s: unknown IPMIFruSection '%s'" % (where, section))
+    if name not in vpd_keys[section]:
+        sys.exit(
+            "%s: unknown IPMIFruProperty '%s' in section '%s'"
+            % (where, name, section)
+        )
+
+    # Custom fields may hold "key:value", only those are ever split.
+    delimiter = property_value.get("IPMIFruValueDelimiter")
+    if not delimiter or not name.startswith("Custom Field"):
+        delimiter = 0
+
+    return vpd_keys[section][name], "'\\x%02x'" % delimiter
+
+
 def generate_cpp(inventory_yaml, output_dir):
     with open(inventory_yaml, "r") as f:
         ifile = yaml.safe_load(f)
         if not isinstance(ifile, dict):
             ifile = {}
 
+        for fruId, instanceList in ifile.items():
+            for instancePath, instanceInfo in instanceList.items():
+                interfaces = instanceInfo.get("interfaces") or {}
+                for interface, properties in interfaces.items():
+                    for dbus_property, value in (properties or {}).items():
+                        if value is None:
+                            value = properties[dbus_property] = {}
+                        where = "FRU %s %s %s.%s" % (
+                            fruId,
+                            instancePath,
+                            interface,
+                            dbus_property,
+                        )
+                        value["vpdKey"], value["delimiter"] = resolve_vpd_key(
+                            where, value
+                        )
+
         # Render the mako template
 
         t = Template(filename=os.path.join(script_dir, "writefru.cpp.mako"))
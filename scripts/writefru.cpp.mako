@@ -1,42 +1,61 @@
 // !!! WARNING: This is a GENERATED Code..Please do NOT Edit !!!
-#include <iostream>
 #include "frup.hpp"
 
-extern const FruMap frus = {
-% for key in fruDict.keys():
-   {${key},{
+#include <array>
+#include <utility>
 <%
-    instanceList = fruDict[key]
-%>
-    % for instancePath,instanceInfo in instanceList.items():
+    maxFruId = max(fruDict.keys(), default=-1)
+%>\
+
+// Everything below is constant initialized, so it lives in .rodata and costs
+// nothing when the library is loaded.
+namespace
+{
+% for fruId, instanceList in fruDict.items():
+    % for instanceIndex, (instancePath, instanceInfo) in enumerate(instanceList.items()):
 <%
-        entityID = instanceInfo["entityID"]
-        entityInstance = instanceInfo["entityInstance"]
         interfaces = instanceInfo["interfaces"]
-%>
-         {${entityID}, ${entityInstance}, "${instancePath}",{
-         % for interface,properties in interfaces.items():
-             {"${interface}",{
-            % if properties:
-                % for dbus_property,property_value in properties.items():
-                    {"${dbus_property}",{
-                        "${property_value.get("IPMIFruSection", "")}",
-                        "${property_value.get("IPMIFruProperty", "")}",\
+%>\
+        % for interfaceIndex, (interface, properties) in enumerate(interfaces.items()):
 <%
-    delimiter = property_value.get("IPMIFruValueDelimiter")
-    if not delimiter:
-        delimiter = ""
-    else:
-        delimiter = '\\' + hex(delimiter)[1:]
-%>
-                     "${delimiter}"
-                 }},
-                % endfor
-            %endif
-             }},
-         % endfor
-        }},
+            properties = properties or {}
+%>\
+
+constexpr std::array<std::pair<DbusProperty, IPMIFruData>, ${len(properties)}>
+    fru${fruId}_${instanceIndex}_${interfaceIndex}{{
+            % for dbus_property, property_value in properties.items():
+        {"${dbus_property}",
+         {${property_value["vpdKey"]}, ${property_value["delimiter"]}}},
+            % endfor
+    }};
+        % endfor
+
+constexpr std::array<std::pair<DbusInterface, DbusPropertyVec>, ${len(interfaces)}>
+    fru${fruId}_${instanceIndex}{{
+        % for interfaceIndex, interface in enumerate(interfaces.keys()):
+        {"${interface}", fru${fruId}_${instanceIndex}_${interfaceIndex}},
+        % endfor
+    }};
+    % endfor
+
+constexpr std::array<FruInstance, ${len(instanceList)}> fru${fruId}{{
+    % for instanceIndex, (instancePath, instanceInfo) in enumerate(instanceList.items()):
+    {${instanceInfo["entityID"]}, ${instanceInfo["entityInstance"]}, "${instancePath}", fru${fruId}_${instanceIndex}},
     % endfor
-   }},
+}};
 % endfor
-};
+
+// Indexed by FRU ID, IDs missing from the YAML have no instances.
+constexpr std::array<FruInstanceVec, ${maxFruId + 1}> fruTable{{
+% for fruId in range(maxFruId + 1):
+    % if fruId in fruDict:
+    fru${fruId},
+    % else:
+    {},
+    % endif
+% endfor
+}};
+
+} // namespace
+
+extern constinit const FruMap frus = fruTable;
@@ -1,85 +1,361 @@
-#include "writefrudata.hpp"
+#include "config.h"
 
-#include <unistd.h>
+#include "fru_stats.hpp"
+#include "fru_trace.hpp"
+#include "writefrudata.hpp"
 
 #include <ipmid/api-types.hpp>
 #include <ipmid/handler.hpp>
 #include <phosphor-logging/lg2.hpp>
 #include <sdbusplus/bus.hpp>
+#include <sdbusplus/timer.hpp>
 
+#include <algorithm>
+#include <chrono>
+#include <cstdint>
 #include <cstdio>
-#include <cstring>
+#include <map>
+#include <memory>
+#include <string>
+#include <vector>
 
 void registerNetFnStorageWriteFru() __attribute__((constructor));
 
 sd_bus* ipmid_get_sd_bus_connection(void);
+sd_event* ipmid_get_sd_event_connection(void);
 
-///-------------------------------------------------------
-// Called by IPMI netfn router for write fru data command
-//--------------------------------------------------------
-ipmi::RspType<uint8_t> ipmiStorageWriteFruData(uint8_t fruId, uint16_t offset,
-                                               std::vector<uint8_t>& buffer)
+namespace
 {
-    FILE* fp = nullptr;
-    char fruFilename[16] = {0};
-    const char* mode = "rb+";
 
-    // Maintaining a temporary file to pump the data
+// How long the host has to stop writing before a FRU image that never
+// became complete is published anyway. Zero disables the timer.
+constexpr auto quietPeriod =
+    std::chrono::milliseconds(FRU_WRITE_QUIET_PERIOD_MS);
+
+/**
+ * State of a FRU image that the host is writing in chunks.
+ */
+struct PendingFru
+{
+    // The bytes written so far. This is what gets validated and published.
+    std::vector<uint8_t> data;
+
+    // Number of bytes written contiguously from offset 0 since the image was
+    // last committed. A rewrite of part of a committed image then waits for
+    // the quiet period rather than being committed chunk by chunk.
+    size_t written = 0;
+
+    // Whether the current contents have been published already.
+    bool committed = true;
+
+    // The part of data written since it last validated, so that only the
+    // areas in it are parsed again. All of it until it first validates.
+    size_t dirtyBegin = 0;
+    size_t dirtyEnd = SIZE_MAX;
+
+    // Publishes the image once the host has been idle for quietPeriod.
+    std::unique_ptr<sdbusplus::Timer> quietTimer;
+};
+
+std::map<uint8_t, PendingFru> pendingFrus;
+
+/**
+ * Get the name of the file the staged FRU data is flushed to.
+ *
+ * @param[in] fruId - the FRU ID
+ * @return the file name
+ */
+std::string getFruFilename(uint8_t fruId)
+{
+    char fruFilename[16] = {0};
     std::sprintf(fruFilename, "%s%02x", "/tmp/ipmifru", fruId);
+    return fruFilename;
+}
 
-    lg2::debug(
-        "IPMI WRITE-FRU-DATA, file name: {FILE}, offset: {OFFSET}, length: {LENGTH}",
-        "FILE", fruFilename, "OFFSET", offset, "LENGTH", buffer.size());
+/**
+ * Writes a staged FRU image out to its file in tmpfs, so that it stays
+ * visible if ipmid goes away.
+ *
+ * @param[in] fruId - the FRU ID
+ * @param[in] data - the staged FRU image
+ */
+void flushFru(uint8_t fruId, const std::vector<uint8_t>& data)
+{
+    std::string fruFilename = getFruFilename(fruId);
 
-    if (access(fruFilename, F_OK) == -1)
+    FILE* fp = std::fopen(fruFilename.c_str(), "wb");
+    if (fp == nullptr)
     {
-        mode = "wb";
+        lg2::error("Error trying to write to {FILE}", "FILE", fruFilename);
+        return;
     }
 
-    if ((fp = std::fopen(fruFilename, mode)) != nullptr)
+    if (std::fwrite(data.data(), 1, data.size(), fp) != data.size())
     {
-        if (std::fseek(fp, offset, SEEK_SET))
-        {
-            lg2::error(
-                "Seek into fru file failed, file name: {FILE}, errno: {ERRNO}",
-                "FILE", fruFilename, "ERRNO", errno);
-            std::fclose(fp);
+        lg2::error(
+            "Write into fru file failed, file name: {FILE}, errno: {ERRNO}",
+            "FILE", fruFilename, "ERRNO", errno);
+    }
 
-            return ipmi::responseInvalidFieldRequest();
-        }
+    std::fclose(fp);
+}
 
-        if (std::fwrite(buffer.data(), 1, buffer.size(), fp) != buffer.size())
+/**
+ * Seeds a FRU's staging buffer from its file in tmpfs, so that a host that
+ * only updates part of a FRU written before ipmid restarted keeps the rest.
+ *
+ * @param[in] fruId - the FRU ID
+ * @param[out] data - the staging buffer to fill
+ */
+void loadFru(uint8_t fruId, std::vector<uint8_t>& data)
+{
+    FILE* fp = std::fopen(getFruFilename(fruId).c_str(), "rb");
+    if (fp == nullptr)
+    {
+        return;
+    }
+
+    if (std::fseek(fp, 0, SEEK_END) == 0)
+    {
+        long size = std::ftell(fp);
+        if (size > 0)
         {
-            lg2::error(
-                "Write into fru file failed, file name: {FILE}, errno: {ERRNO}",
-                "FILE", fruFilename, "ERRNO", errno);
-            std::fclose(fp);
+            data.resize(size);
+            std::rewind(fp);
+            if (std::fread(data.data(), size, 1, fp) != 1)
+            {
+                data.clear();
+            }
+        }
+    }
+
+    std::fclose(fp);
+}
 
-            return ipmi::responseInvalidFieldRequest();
+/**
+ * Gets the staging buffer of a FRU, seeding it from tmpfs the first time the
+ * FRU is touched.
+ *
+ * @param[in] fruId - the FRU ID
+ * @return the staging state of the FRU
+ */
+PendingFru& getPendingFru(uint8_t fruId)
+{
+    auto [iter, inserted] = pendingFrus.try_emplace(fruId);
+    auto& pending = iter->second;
+
+    if constexpr (FRU_WRITE_FLUSH)
+    {
+        if (inserted)
+        {
+            loadFru(fruId, pending.data);
         }
+    }
+
+    return pending;
+}
 
-        std::fclose(fp);
+/**
+ * Gets the image to answer the host's reads of a FRU from: what it has
+ * written, or else the image last validated for the FRU. Reads don't stage
+ * anything for FRUs the host hasn't written.
+ *
+ * @param[in] fruId - the FRU ID
+ * @return the image, or nullptr if there is none
+ */
+const std::vector<uint8_t>* getReadableFru(uint8_t fruId)
+{
+    auto iter = pendingFrus.find(fruId);
+    if (iter != pendingFrus.end() && !iter->second.data.empty())
+    {
+        return &iter->second.data;
     }
-    else
+
+    return getFruImage(fruId);
+}
+
+/**
+ * Validates the staged FRU image and sends it to the inventory controller,
+ * once per image. Only the validation is waited for, the inventory
+ * controller replies through ipmid's event loop.
+ *
+ * @param[in] fruId - the FRU ID
+ */
+void commitFru(uint8_t fruId)
+{
+    auto& pending = pendingFrus[fruId];
+    if (pending.committed)
     {
-        lg2::error("Error trying to write to {FILE}", "FILE", fruFilename);
+        return;
+    }
+    pending.committed = true;
+    pending.written = 0;
+    countFruEvent(fruId, FruCounter::commits);
 
-        return ipmi::responseInvalidFieldRequest();
+    if (pending.quietTimer)
+    {
+        pending.quietTimer->stop();
+    }
+
+    if constexpr (FRU_WRITE_FLUSH)
+    {
+        flushFru(fruId, pending.data);
     }
 
     // Get the reference to global sd_bus object
     sd_bus* bus_type = ipmid_get_sd_bus_connection();
 
-    // We received some bytes. It may be full or partial. Send a valid
-    // FRU file to the inventory controller on DBus for the correct number
     sdbusplus::bus_t bus{bus_type};
-    validateFRUArea(fruId, fruFilename, bus);
+    if (validateFRUArea(fruId, pending.data,
+                        {pending.dirtyBegin,
+                         pending.dirtyEnd - pending.dirtyBegin},
+                        bus) == 0)
+    {
+        pending.dirtyBegin = pending.dirtyEnd = 0;
+    }
+}
+
+/**
+ * Records a chunk written by the host and publishes the image if the common
+ * header says it is complete. Otherwise (re)arms the quiet period timer.
+ *
+ * @param[in] fruId - the FRU ID
+ * @param[in] offset - offset of the chunk in the FRU image
+ * @param[in] buffer - the chunk
+ */
+void stageFruChunk(uint8_t fruId, uint16_t offset,
+                   const std::vector<uint8_t>& buffer)
+{
+    auto& pending = getPendingFru(fruId);
+    size_t end = offset + buffer.size();
+    countFruEvent(fruId, FruCounter::writeChunks);
+    countFruEvent(fruId, FruCounter::writeBytes, buffer.size());
+
+    if (pending.data.size() < end)
+    {
+        pending.data.resize(end, 0);
+    }
+    std::copy(buffer.begin(), buffer.end(), pending.data.begin() + offset);
+
+    if (pending.dirtyBegin == pending.dirtyEnd)
+    {
+        pending.dirtyBegin = offset;
+        pending.dirtyEnd = end;
+    }
+    else
+    {
+        pending.dirtyBegin = std::min<size_t>(pending.dirtyBegin, offset);
+        pending.dirtyEnd = std::max(pending.dirtyEnd, end);
+    }
+
+    // A write to offset 0 starts a new image; anything contiguous with what
+    // we have extends it.
+    if (offset == 0)
+    {
+        pending.written = end;
+    }
+    else if (offset <= pending.written)
+    {
+        pending.written = std::max(pending.written, end);
+    }
+    pending.committed = false;
+
+    size_t imageLen =
+        getFruImageLength(pending.data.data(), pending.data.size());
+    if (imageLen && pending.written >= imageLen)
+    {
+        commitFru(fruId);
+        return;
+    }
+
+    if (quietPeriod.count() == 0)
+    {
+        return;
+    }
+
+    if (!pending.quietTimer)
+    {
+        pending.quietTimer = std::make_unique<sdbusplus::Timer>(
+            ipmid_get_sd_event_connection(), [fruId]() { commitFru(fruId); });
+    }
+    pending.quietTimer->start(quietPeriod);
+}
+
+} // namespace
+
+///-------------------------------------------------------
+// Called by IPMI netfn router for write fru data command
+//--------------------------------------------------------
+ipmi::RspType<uint8_t> ipmiStorageWriteFruData(uint8_t fruId, uint16_t offset,
+                                               std::vector<uint8_t>& buffer)
+{
+    lg2::debug(
+        "IPMI WRITE-FRU-DATA, fru id: {FRUID}, offset: {OFFSET}, length: {LENGTH}",
+        "FRUID", fruId, "OFFSET", offset, "LENGTH", buffer.size());
 
+    FRU_TRACE(write_fru_data_entry, fruId, offset, buffer.size());
+
+    // We received some bytes. It may be full or partial. Only send the FRU
+    // to the inventory controller on DBus once all of it is here, or once the
+    // host stops writing.
+    stageFruChunk(fruId, offset, buffer);
+
+    FRU_TRACE(write_fru_data_return, fruId, buffer.size());
     return ipmi::responseSuccess(buffer.size());
 }
 
+///-------------------------------------------------------
+// Called by IPMI netfn router for get fru inventory area info command
+//--------------------------------------------------------
+ipmi::RspType<uint16_t, uint8_t> ipmiStorageGetFruInventoryAreaInfo(
+    uint8_t fruId)
+{
+    // Always byte access, never word access.
+    constexpr uint8_t accessType = 0;
+
+    const auto* image = getReadableFru(fruId);
+    if (image == nullptr)
+    {
+        return ipmi::responseSensorInvalid();
+    }
+
+    return ipmi::responseSuccess(
+        static_cast<uint16_t>(std::min<size_t>(image->size(), UINT16_MAX)),
+        accessType);
+}
+
+///-------------------------------------------------------
+// Called by IPMI netfn router for read fru data command
+//--------------------------------------------------------
+ipmi::RspType<uint8_t, std::vector<uint8_t>>
+    ipmiStorageReadFruData(uint8_t fruId, uint16_t offset, uint8_t count)
+{
+    lg2::debug(
+        "IPMI READ-FRU-DATA, fru id: {FRUID}, offset: {OFFSET}, count: {COUNT}",
+        "FRUID", fruId, "OFFSET", offset, "COUNT", count);
+
+    // Hosts dumping FRUs read them in many small chunks, so these are served
+    // from memory rather than from the files in tmpfs.
+    const auto* image = getReadableFru(fruId);
+    if (image == nullptr)
+    {
+        return ipmi::responseSensorInvalid();
+    }
+
+    if (offset >= image->size())
+    {
+        return ipmi::responseParmOutOfRange();
+    }
+
+    size_t len = std::min<size_t>(count, image->size() - offset);
+    std::vector<uint8_t> data(image->begin() + offset,
+                              image->begin() + offset + len);
+
+    return ipmi::responseSuccess(static_cast<uint8_t>(len), std::move(data));
+}
+
 //-------------------------------------------------------
-// Registering WRITE FRU DATA command handler with daemon
+// Registering FRU command handlers with daemon
 //-------------------------------------------------------
 void registerNetFnStorageWriteFru()
 {
@@ -91,4 +367,29 @@ void registerNetFnStorageWriteFru()
     ipmi::registerHandler(ipmi::prioOpenBmcBase, ipmi::netFnStorage,
                           ipmi::storage::cmdWriteFruData,
                           ipmi::Privilege::Admin, ipmiStorageWriteFruData);
+
+    // Only the FRUs written through ipmid are in memory here, the EEPROMs
+    // are parsed by phosphor-read-eeprom. So these handlers are only for
+    // systems where the host writes every FRU it reads, and then they have
+    // to take precedence over phosphor-host-ipmid's.
+    if constexpr (FRU_READ_COMMANDS)
+    {
+        lg2::info(
+            "Registering READ FRU DATA command handlers, netfn:{NETFN}, cmds:{CMD1}, {CMD2}",
+            "NETFN", lg2::hex, ipmi::netFnStorage, "CMD1", lg2::hex,
+            ipmi::storage::cmdGetFruInventoryAreaInfo, "CMD2", lg2::hex,
+            ipmi::storage::cmdReadFruData);
+
+        ipmi::registerHandler(ipmi::prioOemBase, ipmi::netFnStorage,
+                              ipmi::storage::cmdGetFruInventoryAreaInfo,
+                              ipmi::Privilege::User,
+                              ipmiStorageGetFruInventoryAreaInfo);
+
+        ipmi::registerHandler(ipmi::prioOemBase, ipmi::netFnStorage,
+                              ipmi::storage::cmdReadFruData,
+                              ipmi::Privilege::User, ipmiStorageReadFruData);
+    }
+
+    sdbusplus::bus_t bus{ipmid_get_sd_bus_connection()};
+    addFruStatsObject(bus);
 }
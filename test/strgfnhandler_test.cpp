@@ -0,0 +1,191 @@
+#include "config.h"
+
+#include "fru_stats.hpp"
+#include "writefrudata.hpp"
+
+#include <systemd/sd-event.h>
+
+#include <ipmid/api-types.hpp>
+#include <ipmid/handler.hpp>
+#include <sdbusplus/bus.hpp>
+
+#include <chrono>
+#include <cstdint>
+#include <cstdio>
+#include <span>
+#include <utility>
+#include <vector>
+
+#include <gtest/gtest.h>
+
+ipmi::RspType<uint8_t> ipmiStorageWriteFruData(uint8_t fruId, uint16_t offset,
+                                               std::vector<uint8_t>& buffer);
+
+sd_bus* ipmid_get_sd_bus_connection(void);
+sd_event* ipmid_get_sd_event_connection(void);
+
+namespace
+{
+
+constexpr auto quietPeriod =
+    std::chrono::milliseconds(FRU_WRITE_QUIET_PERIOD_MS);
+
+// The length the fake common header declares.
+constexpr size_t imageLength = 64;
+
+// The dirty range of every image the handler committed.
+std::vector<std::pair<size_t, size_t>> commits;
+
+} // namespace
+
+// ipmid and the FRU library are faked, only the staging in the handler is
+// under test.
+
+sd_bus* ipmid_get_sd_bus_connection(void)
+{
+    return nullptr;
+}
+
+sd_event* ipmid_get_sd_event_connection(void)
+{
+    static sd_event* event = nullptr;
+    if (event == nullptr)
+    {
+        sd_event_default(&event);
+    }
+    return event;
+}
+
+namespace ipmi::impl
+{
+bool registerHandler(int, NetFn, Cmd, Privilege, HandlerBase::ptr)
+{
+    return true;
+}
+} // namespace ipmi::impl
+
+int validateFRUArea(const uint8_t, std::span<const uint8_t>,
+                    std::pair<size_t, size_t> dirty, sdbusplus::bus_t&)
+{
+    commits.push_back(dirty);
+    return 0;
+}
+
+const std::vector<uint8_t>* getFruImage(const uint8_t)
+{
+    return nullptr;
+}
+
+size_t getFruImageLength(const uint8_t*, const size_t dataLen)
+{
+    return dataLen >= 8 ? imageLength : 0;
+}
+
+void countFruEvent(uint8_t, FruCounter, uint64_t) {}
+
+int addFruStatsObject(sdbusplus::bus_t&)
+{
+    return 0;
+}
+
+namespace
+{
+
+class WriteFruTest : public ::testing::Test
+{
+  protected:
+    void SetUp() override
+    {
+        commits.clear();
+        removeFlushedFru();
+    }
+
+    void TearDown() override
+    {
+        removeFlushedFru();
+    }
+
+    void write(uint16_t offset, size_t len)
+    {
+        std::vector<uint8_t> chunk(len, 0xa5);
+        ipmiStorageWriteFruData(fruId, offset, chunk);
+    }
+
+    // Runs ipmid's event loop until the quiet period timer had its chance
+    // to fire.
+    void waitForQuietPeriod()
+    {
+        auto* event = ipmid_get_sd_event_connection();
+        auto deadline = std::chrono::steady_clock::now() + 2 * quietPeriod;
+        while (std::chrono::steady_clock::now() < deadline)
+        {
+            sd_event_run(event, 10000);
+        }
+    }
+
+    void removeFlushedFru()
+    {
+        char fruFilename[16] = {0};
+        std::sprintf(fruFilename, "%s%02x", "/tmp/ipmifru", fruId);
+        std::remove(fruFilename);
+    }
+
+    // Each test writes a FRU ID of its own, the handler keeps the images
+    // for as long as the process lives.
+    static inline uint8_t nextFruId = 0xf0;
+    uint8_t fruId = nextFruId++;
+};
+
+TEST_F(WriteFruTest, CommitsOnceWhenComplete)
+{
+    for (uint16_t offset = 0; offset < imageLength; offset += 16)
+    {
+        EXPECT_TRUE(commits.empty());
+        write(offset, 16);
+    }
+
+    EXPECT_EQ(commits.size(), 1);
+}
+
+TEST_F(WriteFruTest, PartialRewriteCommitsOnce)
+{
+    if (quietPeriod.count() == 0)
+    {
+        GTEST_SKIP() << "the quiet period timer is disabled";
+    }
+
+    write(0, imageLength);
+    ASSERT_EQ(commits.size(), 1);
+
+    // A host rewriting one area of a complete image, without going back to
+    // offset 0.
+    write(40, 8);
+    write(48, 8);
+    write(56, 8);
+    EXPECT_EQ(commits.size(), 1);
+
+    waitForQuietPeriod();
+    EXPECT_EQ(commits.size(), 2);
+}
+
+TEST_F(WriteFruTest, PartialRewriteReparsesWhatChanged)
+{
+    if (quietPeriod.count() == 0)
+    {
+        GTEST_SKIP() << "the quiet period timer is disabled";
+    }
+
+    write(0, imageLength);
+    ASSERT_EQ(commits.size(), 1);
+
+    // The dirty range covers every chunk of the rewrite, not just the last.
+    write(48, 8);
+    write(16, 8);
+    write(40, 4);
+
+    waitForQuietPeriod();
+    ASSERT_EQ(commits.size(), 2);
+    EXPECT_EQ(commits.back(), std::make_pair(size_t{16}, size_t{40}));
+}
+
+} // namespace
@@ -1,26 +1,53 @@
+#include "config.h"
+
 #include "writefrudata.hpp"
 
 #include "fru_area.hpp"
+#include "fru_cache.hpp"
+#include "fru_log.hpp"
+#include "fru_reader.hpp"
+#include "fru_stats.hpp"
+#include "fru_trace.hpp"
 #include "frup.hpp"
 #include "types.hpp"
 
 #include <ipmid/api.h>
+#include <systemd/sd-bus.h>
 #include <unistd.h>
 
+#if defined(__SSE2__)
+#include <emmintrin.h>
+#elif defined(__ARM_NEON)
+#include <arm_neon.h>
+#endif
+
 #include <phosphor-logging/lg2.hpp>
 #include <sdbusplus/bus.hpp>
+#include <sdbusplus/bus/match.hpp>
+#include <sdbusplus/slot.hpp>
 
 #include <algorithm>
 #include <array>
+#include <atomic>
+#include <chrono>
 #include <cstdio>
 #include <cstring>
 #include <exception>
+#include <functional>
 #include <fstream>
 #include <iostream>
+#include <list>
 #include <map>
 #include <memory>
+#include <optional>
 #include <span>
 #include <sstream>
+#include <string>
+#include <string_view>
+#include <thread>
+#include <type_traits>
+#include <utility>
+#include <variant>
 #include <vector>
 
 using namespace ipmi::vpd;
@@ -28,8 +55,6 @@ using namespace ipmi::vpd;
 extern const FruMap frus;
 extern const std::map<Path, InterfaceMap> extras;
 
-using FruAreaVector = std::vector<std::unique_ptr<IPMIFruArea>>;
-
 namespace
 {
 
@@ -57,80 +82,80 @@ int cleanupError(FILE* fruFilePointer, FruAreaVector& fruAreaVec)
 }
 
 /**
- * Gets the value of the key from the FRU dictionary of the given section.
+ * Gets the value of the key from the FRU dictionary into a property.
  * FRU dictionary is parsed FRU data for all the sections.
  *
- * @param[in] section - FRU section name
- * @param[in] key - key for section
- * @param[in] delimiter - delimiter for parsing custom fields
- * @param[in] fruData - the FRU data to search for the section
- * @return FRU value
+ * @param[in] key - the key of the FRU field
+ * @param[in] delimiter - delimiter for parsing custom fields, or '\0'
+ * @param[in] fruData - the FRU data to get the value from
+ * @param[in,out] value - the property to set to the FRU value
+ * @return whether the property changed
  */
-std::string getFRUValue(const std::string& section, const std::string& key,
-                        const std::string& delimiter, IPMIFruInfo& fruData)
+bool updateFRUValue(openbmc_vpd_key_id key, char delimiter,
+                    const IPMIFruInfo& fruData, Value& value)
 {
-    auto minIndexValue = 0;
-    auto maxIndexValue = 0;
-    std::string fruValue = "";
-
-    if (section == "Board")
-    {
-        minIndexValue = OPENBMC_VPD_KEY_BOARD_MFG_DATE;
-        maxIndexValue = OPENBMC_VPD_KEY_BOARD_MAX;
-    }
-    else if (section == "Product")
-    {
-        minIndexValue = OPENBMC_VPD_KEY_PRODUCT_MFR;
-        maxIndexValue = OPENBMC_VPD_KEY_PRODUCT_MAX;
-    }
-    else if (section == "Chassis")
+    // The parser leaves out the fields the FRU doesn't have, whatever their
+    // type, those get the default for theirs.
+    const FruValue* fruValue = &fruData[key].second;
+    if (auto text = std::get_if<std::string>(fruValue); text && text->empty())
     {
-        minIndexValue = OPENBMC_VPD_KEY_CHASSIS_TYPE;
-        maxIndexValue = OPENBMC_VPD_KEY_CHASSIS_MAX;
+        fruValue = &vpd_key_default(key);
     }
 
-    auto first = fruData.cbegin() + minIndexValue;
-    auto last = first + (maxIndexValue - minIndexValue) + 1;
-
-    auto itr = std::find_if(first, last, [&key](const auto& e) {
-        return key == e.first;
-    });
-
-    if (itr != last)
-    {
-        fruValue = itr->second;
-    }
-
-    // if the key is custom property then the value could be in two formats.
-    // 1) custom field 2 = "value".
-    // 2) custom field 2 =  "key:value".
-    // if delimiter length = 0 i.e custom field 2 = "value"
+    return std::visit(
+        [delimiter, &value](const auto& fruValue) {
+            using T = std::decay_t<decltype(fruValue)>;
+            if constexpr (std::is_same_v<T, std::string>)
+            {
+                std::string_view text = fruValue;
+
+                // if the key is custom property then the value could be in
+                // two formats.
+                // 1) custom field 2 = "value".
+                // 2) custom field 2 =  "key:value".
+                // the generated tables only have a delimiter for custom
+                // fields.
+                if (delimiter != '\0')
+                {
+                    size_t delimiterpos = text.find(delimiter);
+                    if (delimiterpos != std::string_view::npos)
+                    {
+                        text = text.substr(delimiterpos + 1);
+                    }
+                }
 
-    constexpr auto customProp = "Custom Field";
-    if (key.find(customProp) != std::string::npos)
-    {
-        if (delimiter.length() > 0)
-        {
-            size_t delimiterpos = fruValue.find(delimiter);
-            if (delimiterpos != std::string::npos)
+                auto current = std::get_if<std::string>(&value);
+                if (current && *current == text)
+                {
+                    return false;
+                }
+                value = std::string(text);
+            }
+            else
             {
-                fruValue = fruValue.substr(delimiterpos + 1);
+                auto current = std::get_if<T>(&value);
+                if (current && *current == fruValue)
+                {
+                    return false;
+                }
+                value = fruValue;
             }
-        }
-    }
-    return fruValue;
+            return true;
+        },
+        *fruValue);
 }
 
 /**
- * Get the inventory service from the mapper.
+ * Make the call that asks the mapper for the service of an object.
  *
  * @param[in] bus - sdbusplus handle to use for dbus call
  * @param[in] intf - interface
  * @param[in] path - the object path
- * @return the dbus service that owns the interface for that path
+ * @return the method call
  */
-auto getService(sdbusplus::bus_t& bus, const std::string& intf,
-                const std::string& path)
+sdbusplus::message_t newMapperCall(sdbusplus::bus_t& bus,
+                                   const std::string& intf,
+                                   const std::string& path)
 {
     auto mapperCall =
         bus.new_method_call("xyz.openbmc_project.ObjectMapper",
@@ -139,6 +164,62 @@ auto getService(sdbusplus::bus_t& bus, const std::string& intf,
 
     mapperCall.append(path);
     mapperCall.append(std::vector<std::string>({intf}));
+
+    return mapperCall;
+}
+
+// Method calls still waiting for their reply; dropping a slot cancels its
+// call.
+std::list<sdbusplus::slot_t> pendingCalls;
+
+/**
+ * Make a method call without waiting for the reply.
+ *
+ * @param[in] method - the method call
+ * @param[in] onReply - called with the reply, or with an error reply if the
+ *                      call fails later on
+ * @return non-zero if the call could not be made, onReply is not called
+ *         then
+ */
+int callAsync(sdbusplus::message_t& method,
+              std::function<void(sdbusplus::message_t&)> onReply)
+{
+    auto pending = pendingCalls.emplace(pendingCalls.end(), nullptr);
+
+    try
+    {
+        *pending = method.call_async(
+            [pending, onReply = std::move(onReply)](
+                sdbusplus::message_t reply) mutable {
+                // The slot owns this callback, keep the handler around past
+                // letting go of it.
+                auto handler = std::move(onReply);
+                pendingCalls.erase(pending);
+                handler(reply);
+            });
+    }
+    catch (const sdbusplus::exception_t& ex)
+    {
+        pendingCalls.erase(pending);
+        lg2::error("Unable to make dbus call: {ERROR}", "ERROR", ex);
+        return -1;
+    }
+
+    return 0;
+}
+
+/**
+ * Get the inventory service from the mapper.
+ *
+ * @param[in] bus - sdbusplus handle to use for dbus call
+ * @param[in] intf - interface
+ * @param[in] path - the object path
+ * @return the dbus service that owns the interface for that path
+ */
+auto getService(sdbusplus::bus_t& bus, const std::string& intf,
+                const std::string& path)
+{
+    auto mapperCall = newMapperCall(bus, intf, path);
     std::map<std::string, std::vector<std::string>> mapperResponse;
 
     try
@@ -161,98 +242,69 @@ auto getService(sdbusplus::bus_t& bus, const std::string& intf,
 }
 
 /**
- * Takes FRU data, invokes Parser for each FRU record area and updates
- * inventory.
- *
- * @param[in] areaVector - vector of FRU areas
- * @param[in] bus - handle to sdbus for calling methods, etc
- * @return return non-zero of failure
+ * A property whose value comes from the FRU data.
  */
-int updateInventory(FruAreaVector& areaVector, sdbusplus::bus_t& bus)
+struct FruValueSlot
 {
-    // Generic error reporter
-    int rc = 0;
-    uint8_t fruid = 0;
-    IPMIFruInfo fruData;
-
-    // For each FRU area, extract the needed data , get it parsed and update
-    // the Inventory.
-    for (const auto& fruArea : areaVector)
-    {
-        fruid = fruArea->getFruID();
-        // Fill the container with information
-        rc = parse_fru_area(fruArea->getType(),
-                            static_cast<const void*>(fruArea->getData()),
-                            fruArea->getLength(), fruData);
-        if (rc < 0)
-        {
-            lg2::error("Error parsing FRU records: {RC}", "RC", rc);
-            return rc;
-        }
-    } // END walking the vector of areas and updating
-
-    // For each FRU we have the list of instances which needs to be updated.
-    // Each instance object implements certain interfaces.
-    // Each Interface is having Dbus properties.
-    // Each Dbus Property would be having metaData(eg section,VpdPropertyName).
+    ObjectMap::iterator object;
+    InterfaceMap::iterator interface;
+    PropertyMap::iterator property;
+    IPMIFruData source;
+};
 
-    // Here we are just printing the object,interface and the properties.
-    // which needs to be called with the new inventory manager implementation.
-    using namespace std::string_literals;
-    static const auto intf = "xyz.openbmc_project.Inventory.Manager"s;
-    static const auto path = "/xyz/openbmc_project/inventory"s;
-    std::string service;
-    try
-    {
-        service = getService(bus, intf, path);
-    }
-    catch (const std::exception& e)
-    {
-        lg2::error("Failed to get service: {ERROR}", "ERROR", e);
-        return -1;
-    }
+/**
+ * The objects a FRU ID maps to. The structure, along with any extra
+ * properties, is built once; updates only rewrite the value slots.
+ */
+struct FruObjects
+{
+    ObjectMap objects;
+    std::vector<FruValueSlot> slots;
 
-    auto iter = frus.find(fruid);
-    if (iter == frus.end())
-    {
-        lg2::error("Unable to find fru id:({FRUID}) in generated list", "FRUID",
-                   fruid);
-        return -1;
-    }
+    // Whether objects has been sent to the inventory manager in full, so
+    // that only changed slots need to be sent from then on.
+    bool published = false;
+};
 
-    auto& instanceList = iter->second;
-    if (instanceList.size() <= 0)
-    {
-        lg2::debug("Object list empty for this fru id:({FRUID})", "FRUID",
-                   fruid);
-    }
+std::map<uint8_t, FruObjects> fruObjects;
 
-    ObjectMap objects;
+/**
+ * Build the objects for a FRU ID from the generated mapping tables and the
+ * extra properties.
+ *
+ * @param[in] instanceList - the instances the FRU ID maps to
+ * @param[out] fru - the objects and value slots to fill
+ */
+void buildFruObjects(FruInstanceVec instanceList, FruObjects& fru)
+{
     for (const auto& instance : instanceList)
     {
-        InterfaceMap interfaces;
-        const auto& extrasIter = extras.find(instance.path);
+        auto object = fru.objects
+                          .emplace(std::string(instance.path), InterfaceMap{})
+                          .first;
+        auto& interfaces = object->second;
+        const auto& extrasIter = extras.find(std::string(instance.path));
 
         for (const auto& interfaceList : instance.interfaces)
         {
-            PropertyMap props; // store all the properties
+            auto interface =
+                interfaces.emplace(interfaceList.first, PropertyMap{}).first;
+            auto& props = interface->second;
             for (const auto& properties : interfaceList.second)
             {
-                std::string value;
-                decltype(auto) pdata = properties.second;
-
-                if (!pdata.section.empty() && !pdata.property.empty())
+                auto [property, inserted] =
+                    props.emplace(properties.first, std::string());
+                if (inserted && properties.second.key != OPENBMC_VPD_KEY_NONE)
                 {
-                    value = getFRUValue(pdata.section, pdata.property,
-                                        pdata.delimiter, fruData);
+                    fru.slots.push_back(
+                        {object, interface, property, properties.second});
                 }
-                props.emplace(std::move(properties.first), std::move(value));
             }
             // Check and update extra properties
             if (extras.end() != extrasIter)
             {
                 const auto& propsIter =
-                    (extrasIter->second).find(interfaceList.first);
+                    (extrasIter->second).find(std::string(interfaceList.first));
                 if ((extrasIter->second).end() != propsIter)
                 {
                     for (const auto& map : propsIter->second)
@@ -261,197 +313,826 @@ int updateInventory(FruAreaVector& areaVector, sdbusplus::bus_t& bus)
                     }
                 }
             }
-            interfaces.emplace(std::move(interfaceList.first),
-                               std::move(props));
         }
 
-        // Call the inventory manager
-        sdbusplus::object_path objectPath = instance.path;
         // Check and update extra properties
         if (extras.end() != extrasIter)
         {
             for (const auto& entry : extrasIter->second)
             {
-                if (interfaces.end() == interfaces.find(entry.first))
-                {
-                    interfaces.emplace(entry.first, entry.second);
-                }
+                interfaces.emplace(entry.first, entry.second);
             }
         }
-        objects.emplace(objectPath, interfaces);
     }
+}
 
-    auto pimMsg = bus.new_method_call(service.c_str(), path.c_str(),
-                                      intf.c_str(), "Notify");
-    pimMsg.append(std::move(objects));
+/**
+ * A service name resolved through the mapper, along with the match that
+ * forgets it again once the owner of that name changes.
+ */
+struct CachedService
+{
+    std::string service;
+    sdbusplus::slot_t ownerMatch{nullptr};
+};
 
-    try
-    {
-        auto inventoryMgrResponseMsg = bus.call(pimMsg);
-    }
-    catch (const sdbusplus::exception_t& ex)
+// Resolved services, keyed by interface and object path.
+std::map<std::pair<std::string, std::string>, CachedService> serviceCache;
+
+/**
+ * Remember the service that was resolved for an object, until the owner of
+ * the service's name changes.
+ *
+ * @param[in] bus - sdbusplus handle to watch the name on
+ * @param[in,out] cached - the cache entry of the object
+ * @param[in] service - the dbus service
+ */
+void cacheService(sdbusplus::bus_t& bus, CachedService& cached,
+                  const std::string& service)
+{
+    // Only clear the name from the callback; the match gets replaced the
+    // next time the service is resolved. Whatever was published to the old
+    // owner may have gone away with it, so publish everything again.
+    auto onOwnerChanged = [](sd_bus_message*, void* userdata, sd_bus_error*) {
+        static_cast<CachedService*>(userdata)->service.clear();
+        for (auto& [fruid, fru] : fruObjects)
+        {
+            fru.published = false;
+        }
+        return 0;
+    };
+
+    // Without the watch the name could go stale unnoticed, so don't keep it
+    // if the match can't be installed.
+    auto onInstalled = [](sd_bus_message* m, void* userdata, sd_bus_error*) {
+        sdbusplus::message_t reply(m);
+        if (reply.is_method_error())
+        {
+            lg2::error("Unable to watch the inventory service");
+            static_cast<CachedService*>(userdata)->service.clear();
+        }
+        return 0;
+    };
+
+    // Don't wait for the bus to acknowledge the match, that would cost a
+    // round trip on every resolve.
+    auto rule = sdbusplus::bus::match::rules::nameOwnerChanged(service);
+    sd_bus_slot* slot = nullptr;
+    int rc = sd_bus_add_match_async(bus.get(), &slot, rule.c_str(),
+                                    onOwnerChanged, onInstalled, &cached);
+    cached.ownerMatch = sdbusplus::slot_t{slot};
+    if (rc < 0)
     {
-        lg2::error(
-            "Error in notify call, service: {SERVICE}, path: {PATH}, error: {ERROR}",
-            "SERVICE", service, "PATH", path, "ERROR", ex);
-        return -1;
+        lg2::error("Unable to watch the inventory service, error: {ERRNO}",
+                   "ERRNO", std::strerror(-rc));
+        cached.service.clear();
+        return;
     }
 
-    return rc;
+    cached.service = service;
 }
 
-} // namespace
-
 /**
- * Takes the pointer to stream of bytes and length and returns the 8 bit
- * checksum.  This algo is per IPMI V2.0 spec
+ * Get the inventory service, only going to the mapper if it hasn't been
+ * resolved already or its owner has changed since.
  *
- * @param[in] data - data for running crc
- * @param[in] len - the length over which to run the crc
- * @return the CRC value
+ * @param[in] bus - sdbusplus handle to use for dbus call
+ * @param[in] intf - interface
+ * @param[in] path - the object path
+ * @return the dbus service that owns the interface for that path
  */
-unsigned char calculateCRC(const unsigned char* data, size_t len)
+std::string getCachedService(sdbusplus::bus_t& bus, const std::string& intf,
+                             const std::string& path)
 {
-    char crc = 0;
-    size_t byte = 0;
-
-    for (byte = 0; byte < len; byte++)
+    auto& cached = serviceCache[{intf, path}];
+    if (!cached.service.empty())
     {
-        crc += *data++;
+        return cached.service;
     }
 
-    return (-crc);
+    auto service = getService(bus, intf, path);
+    cacheService(bus, cached, service);
+
+    return service;
 }
 
 /**
- * Accepts a FRU area offset into a common header and tells which area it is.
+ * Get the inventory service like getCachedService(), but without waiting
+ * for the mapper.
  *
- * @param[in] areaOffset - offset to lookup the area type
- * @return the ipmi_fru_area_type
+ * @param[in] bus - sdbusplus handle to use for dbus call
+ * @param[in] intf - interface
+ * @param[in] path - the object path
+ * @param[in] onService - called with the dbus service that owns the
+ *                        interface for that path, or with an empty string
+ *                        if it can't be resolved
  */
-ipmi_fru_area_type getFruAreaType(uint8_t areaOffset)
+void getCachedServiceAsync(sdbusplus::bus_t& bus, const std::string& intf,
+                           const std::string& path,
+                           std::function<void(const std::string&)> onService)
 {
-    ipmi_fru_area_type type = IPMI_FRU_AREA_TYPE_MAX;
-
-    switch (areaOffset)
+    auto& cached = serviceCache[{intf, path}];
+    if (!cached.service.empty())
     {
-        case IPMI_FRU_INTERNAL_OFFSET:
-            type = IPMI_FRU_AREA_INTERNAL_USE;
-            break;
-
-        case IPMI_FRU_CHASSIS_OFFSET:
-            type = IPMI_FRU_AREA_CHASSIS_INFO;
-            break;
+        onService(cached.service);
+        return;
+    }
 
-        case IPMI_FRU_BOARD_OFFSET:
-            type = IPMI_FRU_AREA_BOARD_INFO;
-            break;
+    auto mapperCall = newMapperCall(bus, intf, path);
+    sd_bus* busp = bus.get();
+    auto onReply = [busp, &cached,
+                    onService](sdbusplus::message_t& mapperResponseMsg) {
+        std::map<std::string, std::vector<std::string>> mapperResponse;
+        try
+        {
+            if (mapperResponseMsg.is_method_error())
+            {
+                throw sdbusplus::exception::SdBusError(
+                    mapperResponseMsg.get_error(), "GetObject");
+            }
+            mapperResponseMsg.read(mapperResponse);
+        }
+        catch (const sdbusplus::exception_t& ex)
+        {
+            lg2::error("Exception from sdbus call: {ERROR}", "ERROR", ex);
+            onService({});
+            return;
+        }
 
-        case IPMI_FRU_PRODUCT_OFFSET:
-            type = IPMI_FRU_AREA_PRODUCT_INFO;
-            break;
+        if (mapperResponse.begin() == mapperResponse.end())
+        {
+            lg2::error("ERROR in reading the mapper response");
+            onService({});
+            return;
+        }
 
-        case IPMI_FRU_MULTI_OFFSET:
-            type = IPMI_FRU_AREA_MULTI_RECORD;
-            break;
+        const auto& service = mapperResponse.begin()->first;
+        sdbusplus::bus_t bus{busp};
+        cacheService(bus, cached, service);
+        onService(service);
+    };
 
-        default:
-            type = IPMI_FRU_AREA_TYPE_MAX;
+    if (callAsync(mapperCall, std::move(onReply)) < 0)
+    {
+        onService({});
     }
-
-    return type;
 }
 
 /**
- * Validates the data for multirecord fields and CRC if selected
+ * Forget a cached service, e.g. because calling it failed.
  *
- * @param[in] data - the data to verify
- * @param[in] len - the length of the region to verify
- * @param[in] validateCrc - whether to validate the CRC
- * @return non-zero on failure
+ * @param[in] intf - interface
+ * @param[in] path - the object path
  */
-int verifyFruMultiRecData(const uint8_t* data, const size_t len,
-                          bool validateCrc)
+void invalidateService(const std::string& intf, const std::string& path)
 {
-    uint8_t checksum = 0;
-    int rc = -1;
-
-    if (!validateCrc)
-    {
-        // There's nothing else to do for this area.
-        return EXIT_SUCCESS;
-    }
-
-    // As per the IPMI platform spec, byte[3] is the record checksum.
-    checksum = calculateCRC(data, len);
-    if (checksum != data[3])
+    auto iter = serviceCache.find({intf, path});
+    if (iter != serviceCache.end())
     {
-        lg2::debug("Checksum mismatch, Calculated={CALC}, Embedded={EMBED}",
-                   "CALC", lg2::hex, checksum, "EMBED", lg2::hex, data[3]);
-        return rc;
+        iter->second.service.clear();
     }
-
-    return EXIT_SUCCESS;
 }
 
 /**
- * Validates the data for mandatory fields and CRC if selected.
+ * Write parsed FRU data into the value slots of a FRU's objects and collect
+ * what the inventory manager needs to be sent for it.
  *
- * @param[in] data - the data to verify
- * @param[in] len - the length of the region to verify
- * @param[in] validateCrc - whether to validate the CRC
- * @return non-zero on failure
+ * @param[in] fru - the objects of the FRU
+ * @param[in] fruData - the parsed FRU data
+ * @param[in,out] objects - the objects to send, to merge the FRU's into
+ * @return whether anything needs to be sent for this FRU
  */
-int verifyFruData(const uint8_t* data, const size_t len, bool validateCrc)
+bool fillFruObjects(FruObjects& fru, const IPMIFruInfo& fruData,
+                    ObjectMap& objects)
 {
-    uint8_t checksum = 0;
-    int rc = -1;
+    bool changed = false;
 
-    // Validate for first byte to always have a value of [1]
-    if (data[0] != IPMI_FRU_HDR_BYTE_ZERO)
+    for (auto& slot : fru.slots)
     {
-        lg2::error("Invalid entry in byte-0, entry: {ENTRY}", "ENTRY", lg2::hex,
-                   data[0]);
-        return rc;
+        auto& current = slot.property->second;
+        if (!updateFRUValue(slot.source.key, slot.source.delimiter, fruData,
+                            current))
+        {
+            continue;
+        }
+        changed = true;
+
+        if (fru.published)
+        {
+            objects[slot.object->first][slot.interface->first]
+                .insert_or_assign(slot.property->first, current);
+        }
     }
-    lg2::debug("Validated in entry_1 of fruData,entry: {ENTRY}", "ENTRY",
-               lg2::hex, data[0]);
 
-    if (!validateCrc)
+    if (fru.published)
     {
-        // There's nothing else to do for this area.
-        return EXIT_SUCCESS;
+        return changed;
     }
 
-    // See if the calculated CRC matches with the embedded one.
-    // CRC to be calculated on all except the last one that is CRC itself.
-    checksum = calculateCRC(data, len - 1);
-    if (checksum != data[len - 1])
+    // Several FRU IDs may map onto the same object, so merge rather than
+    // replace. Where they share a property the later FRU wins, as it does
+    // when only changes are sent.
+    for (const auto& [objectPath, interfaces] : fru.objects)
     {
-        lg2::debug("Checksum mismatch, Calculated={CALC}, Embedded={EMBED}",
-                   "CALC", lg2::hex, checksum, "EMBED", lg2::hex, data[len]);
-        return rc;
+        auto& object = objects[objectPath];
+        for (const auto& [interface, props] : interfaces)
+        {
+            auto& merged = object[interface];
+            for (const auto& [property, value] : props)
+            {
+                merged.insert_or_assign(property, value);
+            }
+        }
     }
-
-    return EXIT_SUCCESS;
+    return true;
 }
 
 /**
- * Checks if a particular FRU area is populated or not.
+ * Sends objects to the inventory manager over D-Bus.
  *
- * @param[in] reference to FRU area pointer
- * @return true if the area is empty
+ * @param[in] bus - handle to sdbus for calling methods, etc
+ * @param[in] objects - the objects to send
+ * @param[in] fruids - the FRUs the objects are for
+ * @return return non-zero of failure
  */
-bool removeInvalidArea(const std::unique_ptr<IPMIFruArea>& fruArea)
+int notifyInventoryManager(sdbusplus::bus_t& bus, ObjectMap& objects,
+                           std::span<const uint8_t> fruids)
 {
-    // Filter the ones that are empty
-    if (!(fruArea->getLength()))
+    using namespace std::string_literals;
+    static const auto intf = "xyz.openbmc_project.Inventory.Manager"s;
+    static const auto path = "/xyz/openbmc_project/inventory"s;
+
+    auto start = std::chrono::steady_clock::now();
+    std::string service;
+    try
     {
-        return true;
+        service = getCachedService(bus, intf, path);
+    }
+    catch (const std::exception& e)
+    {
+        lg2::error("Failed to get service: {ERROR}", "ERROR", e);
+        return -1;
+    }
+    auto resolved = std::chrono::steady_clock::now();
+    recordFruStage(fruids, FruStage::mapperLookup, resolved - start);
+
+    auto pimMsg = bus.new_method_call(service.c_str(), path.c_str(),
+                                      intf.c_str(), "Notify");
+    pimMsg.append(std::move(objects));
+
+    try
+    {
+        auto inventoryMgrResponseMsg = bus.call(pimMsg);
+    }
+    catch (const sdbusplus::exception_t& ex)
+    {
+        lg2::error(
+            "Error in notify call, service: {SERVICE}, path: {PATH}, error: {ERROR}",
+            "SERVICE", service, "PATH", path, "ERROR", ex);
+        invalidateService(intf, path);
+        return -1;
+    }
+    recordFruStage(fruids, FruStage::notify,
+                   std::chrono::steady_clock::now() - resolved);
+
+    return 0;
+}
+
+/**
+ * Sends objects to the inventory manager over D-Bus, without waiting for
+ * either the mapper or the inventory manager.
+ *
+ * @param[in] bus - handle to sdbus for calling methods, etc
+ * @param[in] objects - the objects to send
+ * @param[in] fruids - the FRUs the objects are for
+ * @param[in] onDone - called with non-zero on failure, once the inventory
+ *                     manager has replied
+ */
+void notifyInventoryManagerAsync(sdbusplus::bus_t& bus, ObjectMap objects,
+                                 std::vector<uint8_t> fruids,
+                                 std::function<void(int)> onDone)
+{
+    using namespace std::string_literals;
+    static const auto intf = "xyz.openbmc_project.Inventory.Manager"s;
+    static const auto path = "/xyz/openbmc_project/inventory"s;
+
+    sd_bus* busp = bus.get();
+    auto start = std::chrono::steady_clock::now();
+    auto onService = [busp, objects = std::move(objects), fruids, start,
+                      onDone](const std::string& service) mutable {
+        if (service.empty())
+        {
+            lg2::error("Failed to get service for {PATH}", "PATH", path);
+            onDone(-1);
+            return;
+        }
+        auto resolved = std::chrono::steady_clock::now();
+        recordFruStage(fruids, FruStage::mapperLookup, resolved - start);
+
+        sdbusplus::bus_t bus{busp};
+        auto pimMsg = bus.new_method_call(service.c_str(), path.c_str(),
+                                          intf.c_str(), "Notify");
+        pimMsg.append(std::move(objects));
+
+        auto onReply = [service, fruids, resolved,
+                        onDone](sdbusplus::message_t& reply) {
+            if (reply.is_method_error())
+            {
+                sdbusplus::exception::SdBusError ex(reply.get_error(),
+                                                    "Notify");
+                lg2::error(
+                    "Error in notify call, service: {SERVICE}, path: {PATH}, error: {ERROR}",
+                    "SERVICE", service, "PATH", path, "ERROR", ex);
+                invalidateService(intf, path);
+                onDone(-1);
+                return;
+            }
+            recordFruStage(fruids, FruStage::notify,
+                           std::chrono::steady_clock::now() - resolved);
+            onDone(0);
+        };
+
+        if (callAsync(pimMsg, std::move(onReply)) < 0)
+        {
+            onDone(-1);
+        }
+    };
+
+    getCachedServiceAsync(bus, intf, path, std::move(onService));
+}
+
+/**
+ * A FRU whose objects are being sent to the inventory manager.
+ */
+struct SentFru
+{
+    uint8_t fruid;
+    FruObjects* fru;
+
+    // Whether all of its objects are being sent, rather than only what
+    // changed.
+    bool full;
+};
+
+/**
+ * Collect what the inventory manager needs to be sent for parsed FRU data.
+ *
+ * @param[in] parsedFrus - the FRU IDs and their parsed data
+ * @param[out] objects - the objects to send
+ * @param[out] sent - the FRUs that objects has something of
+ * @return non-zero if any of the FRU IDs are not known
+ */
+int collectInventory(std::span<const ParsedFru> parsedFrus,
+                     ObjectMap& objects, std::vector<SentFru>& sent)
+{
+    // Generic error reporter
+    int rc = 0;
+
+    // For each FRU we have the list of instances which needs to be updated.
+    // Each instance object implements certain interfaces.
+    // Each Interface is having Dbus properties.
+    // Each Dbus Property would be having metaData(eg section,VpdPropertyName).
+    for (const auto& [fruid, fruData, cached] : parsedFrus)
+    {
+        auto [fruIter, inserted] = fruObjects.try_emplace(fruid);
+        auto& fru = fruIter->second;
+        if (inserted)
+        {
+            if (fruid >= frus.size() || frus[fruid].empty())
+            {
+                lg2::error("Unable to find fru id:({FRUID}) in generated list",
+                           "FRUID", fruid);
+                fruObjects.erase(fruIter);
+                rc = -1;
+                continue;
+            }
+            buildFruObjects(frus[fruid], fru);
+        }
+
+        // An unchanged image was published by an earlier run, and the
+        // inventory manager may be trusted to have kept it. Once it has
+        // been seen here, the usual rules apply.
+        if (FRU_CACHE_SKIP_NOTIFY && cached && inserted)
+        {
+            ObjectMap unsent;
+            fillFruObjects(fru, fruData, unsent);
+            fru.published = true;
+            lg2::debug("Inventory kept for fru id:({FRUID})", "FRUID", fruid);
+            continue;
+        }
+
+        // Only send what the inventory manager doesn't have already.
+        FruStageTimer timer(fruid, FruStage::mapBuild);
+        bool full = !fru.published;
+        if (fillFruObjects(fru, fruData, objects))
+        {
+            sent.push_back({fruid, &fru, full});
+        }
+        else
+        {
+            lg2::debug("Inventory unchanged for fru id:({FRUID})", "FRUID",
+                       fruid);
+        }
+    }
+
+    return rc;
+}
+
+/**
+ * Check whether the inventory manager has all of a FRU's objects.
+ *
+ * @param[in] fruid - the FRU ID
+ * @return false too if the FRU ID is not in the generated tables
+ */
+bool isFruPublished(uint8_t fruid)
+{
+    auto iter = fruObjects.find(fruid);
+    return iter != fruObjects.end() && iter->second.published;
+}
+
+/**
+ * Note whether the objects sent for FRUs got to the inventory manager.
+ *
+ * @param[in] sent - the FRUs objects were sent for
+ * @param[in] published - whether the inventory manager has them
+ */
+void setPublished(std::span<const SentFru> sent, bool published)
+{
+    // The slots are ahead of the inventory once a call fails, and only
+    // sending everything again catches it up, whatever other calls made it
+    // in the meantime.
+    for (auto [fruid, fru, full] : sent)
+    {
+        if (!published)
+        {
+            countFruEvent(fruid, FruCounter::publishFailures);
+            fru->published = false;
+        }
+        else if (full)
+        {
+            fru->published = true;
+        }
+    }
+}
+
+/**
+ * Takes parsed FRU data and updates the inventory with all of it in one
+ * call.
+ *
+ * @param[in] parsedFrus - the FRU IDs and their parsed data
+ * @param[in] bus - handle to sdbus for calling methods, etc
+ * @return return non-zero of failure
+ */
+int updateInventory(std::span<const ParsedFru> parsedFrus,
+                    sdbusplus::bus_t& bus)
+{
+    return updateInventory(
+        parsedFrus,
+        [&bus](ObjectMap& objects, std::span<const uint8_t> fruids) {
+            return notifyInventoryManager(bus, objects, fruids);
+        });
+}
+
+/**
+ * Takes parsed FRU data and updates the inventory with all of it in one
+ * call, without waiting for the call to complete. Failures to publish are
+ * only logged.
+ *
+ * @param[in] parsedFrus - the FRU IDs and their parsed data
+ * @param[in] bus - handle to sdbus for calling methods, etc
+ * @return return non-zero if any of the FRU IDs are not known
+ */
+int updateInventoryAsync(std::span<const ParsedFru> parsedFrus,
+                         sdbusplus::bus_t& bus)
+{
+    FRU_TRACE(update_inventory_entry, parsedFrus.size());
+
+    ObjectMap objects;
+    std::vector<SentFru> sent;
+    int rc = collectInventory(parsedFrus, objects, sent);
+    if (sent.empty())
+    {
+        FRU_TRACE(update_inventory_return, rc, 0);
+        return rc;
+    }
+
+    std::vector<uint8_t> fruids;
+    for (const auto& sentFru : sent)
+    {
+        fruids.push_back(sentFru.fruid);
+    }
+
+    // Nothing is waited for from here on, the call only goes out.
+    FRU_TRACE(update_inventory_return, rc, fruids.size());
+    notifyInventoryManagerAsync(
+        bus, std::move(objects), std::move(fruids),
+        [sent = std::move(sent)](int rc) {
+            setPublished(sent, rc == 0);
+            if (rc < 0)
+            {
+                lg2::error("Error updating inventory.");
+            }
+        });
+
+    return rc;
+}
+
+} // namespace
+
+int updateInventory(std::span<const ParsedFru> parsedFrus,
+                    const InventoryNotify& notify)
+{
+    FRU_TRACE(update_inventory_entry, parsedFrus.size());
+
+    ObjectMap objects;
+    std::vector<SentFru> sent;
+    int rc = collectInventory(parsedFrus, objects, sent);
+    if (sent.empty())
+    {
+        FRU_TRACE(update_inventory_return, rc, 0);
+        return rc;
+    }
+
+    std::vector<uint8_t> fruids;
+    for (const auto& sentFru : sent)
+    {
+        fruids.push_back(sentFru.fruid);
+    }
+
+    bool published = notify(objects, fruids) == 0;
+    setPublished(sent, published);
+
+    rc = published ? rc : -1;
+    FRU_TRACE(update_inventory_return, rc, fruids.size());
+    return rc;
+}
+
+namespace
+{
+
+/**
+ * Sums bytes modulo 256. The vector loops take 16 bytes at a time and the
+ * scalar loop takes whatever is left, or everything on targets without SSE2
+ * or NEON.
+ *
+ * @param[in] src - the bytes to sum
+ * @param[in] len - the number of bytes
+ * @return the sum of the bytes
+ */
+uint8_t sumBytes(const uint8_t* src, size_t len)
+{
+    size_t i = 0;
+    uint8_t sum = 0;
+
+#if defined(__SSE2__)
+    const __m128i zero = _mm_setzero_si128();
+    __m128i acc = _mm_setzero_si128();
+    for (; i + 16 <= len; i += 16)
+    {
+        __m128i v = _mm_loadu_si128(reinterpret_cast<const __m128i*>(src + i));
+        // Two 64-bit sums of 8 bytes each, the low 8 bits are all we need.
+        acc = _mm_add_epi64(acc, _mm_sad_epu8(v, zero));
+    }
+    sum = _mm_cvtsi128_si32(acc) + _mm_extract_epi16(acc, 4);
+#elif defined(__ARM_NEON)
+    uint16x8_t acc = vdupq_n_u16(0);
+    for (; i + 16 <= len; i += 16)
+    {
+        uint8x16_t v = vld1q_u8(src + i);
+        // Pairwise add into 16-bit lanes. They may wrap, which doesn't
+        // change the sum modulo 256.
+        acc = vpadalq_u8(acc, v);
+    }
+    uint16_t lanes[8];
+    vst1q_u16(lanes, acc);
+    for (auto lane : lanes)
+    {
+        sum += lane;
+    }
+#endif
+
+    for (; i < len; i++)
+    {
+        sum += src[i];
+    }
+
+    return sum;
+}
+
+} // namespace
+
+/**
+ * Takes the pointer to stream of bytes and length and returns the 8 bit
+ * checksum.  This algo is per IPMI V2.0 spec
+ *
+ * @param[in] data - data for running crc
+ * @param[in] len - the length over which to run the crc
+ * @return the CRC value
+ */
+unsigned char calculateCRC(const unsigned char* data, size_t len)
+{
+    return -sumBytes(data, len);
+}
+
+/**
+ * Accepts a FRU area offset into a common header and tells which area it is.
+ *
+ * @param[in] areaOffset - offset to lookup the area type
+ * @return the ipmi_fru_area_type
+ */
+ipmi_fru_area_type getFruAreaType(uint8_t areaOffset)
+{
+    ipmi_fru_area_type type = IPMI_FRU_AREA_TYPE_MAX;
+
+    switch (areaOffset)
+    {
+        case IPMI_FRU_INTERNAL_OFFSET:
+            type = IPMI_FRU_AREA_INTERNAL_USE;
+            break;
+
+        case IPMI_FRU_CHASSIS_OFFSET:
+            type = IPMI_FRU_AREA_CHASSIS_INFO;
+            break;
+
+        case IPMI_FRU_BOARD_OFFSET:
+            type = IPMI_FRU_AREA_BOARD_INFO;
+            break;
+
+        case IPMI_FRU_PRODUCT_OFFSET:
+            type = IPMI_FRU_AREA_PRODUCT_INFO;
+            break;
+
+        case IPMI_FRU_MULTI_OFFSET:
+            type = IPMI_FRU_AREA_MULTI_RECORD;
+            break;
+
+        default:
+            type = IPMI_FRU_AREA_TYPE_MAX;
+    }
+
+    return type;
+}
+
+/**
+ * Validates the data for mandatory fields and CRC if selected.
+ *
+ * @param[in] data - the data to verify
+ * @param[in] len - the length of the region to verify
+ * @param[in] validateCrc - whether to validate the CRC
+ * @return non-zero on failure
+ */
+int verifyFruData(const uint8_t* data, const size_t len, bool validateCrc)
+{
+    uint8_t checksum = 0;
+    int rc = -1;
+
+    // Validate for first byte to always have a value of [1]
+    if (data[0] != IPMI_FRU_HDR_BYTE_ZERO)
+    {
+        lg2::error("Invalid entry in byte-0, entry: {ENTRY}", "ENTRY", lg2::hex,
+                   data[0]);
+        return rc;
+    }
+    FRU_DEBUG("Validated in entry_1 of fruData,entry: {ENTRY}", "ENTRY",
+              lg2::hex, data[0]);
+
+    if (!validateCrc)
+    {
+        // There's nothing else to do for this area.
+        return EXIT_SUCCESS;
+    }
+
+    // See if the calculated CRC matches with the embedded one.
+    // CRC to be calculated on all except the last one that is CRC itself.
+    checksum = calculateCRC(data, len - 1);
+    if (checksum != data[len - 1])
+    {
+        FRU_DEBUG("Checksum mismatch, Calculated={CALC}, Embedded={EMBED}",
+                  "CALC", lg2::hex, checksum, "EMBED", lg2::hex, data[len]);
+        return rc;
+    }
+
+    return EXIT_SUCCESS;
+}
+
+/**
+ * Checks if a particular FRU area is populated or not.
+ *
+ * @param[in] reference to FRU area pointer
+ * @return true if the area is empty
+ */
+bool removeInvalidArea(const std::unique_ptr<IPMIFruArea>& fruArea)
+{
+    // Filter the ones that are empty
+    if (!(fruArea->getLength()))
+    {
+        return true;
     }
     return false;
 }
 
+/**
+ * Validates one of the areas the common header references.
+ *
+ * @prereq : This must be called only after validating common header
+ * @param[in] fruData - pointer to the FRU bytes
+ * @param[in] dataLen - the length of the FRU data
+ * @param[in] fruEntry - the common header entry of the area
+ * @param[out] areaData - the area, empty if the FRU doesn't have it
+ * @return non-zero on failure
+ */
+int ipmiValidateFruArea(const uint8_t* fruData, const size_t dataLen,
+                        uint8_t fruEntry, std::span<const uint8_t>& areaData)
+{
+    int rc = -1;
+    areaData = {};
+
+    // Actual offset in the payload is the offset mentioned in common header
+    // multiplied by 8. Common header is always the first 8 bytes.
+    size_t areaOffset = fruData[fruEntry] * IPMI_EIGHT_BYTES;
+    if (!areaOffset)
+    {
+        return EXIT_SUCCESS;
+    }
+
+    if (dataLen < (areaOffset + 2))
+    {
+        // Our file size is less than what it needs to be. +2 because we are
+        // using area len that is at 2 byte off areaOffset
+        lg2::error("FRU file is incomplete, size: {SIZE}", "SIZE", dataLen);
+        return rc;
+    }
+
+    // Read 3 bytes to know the actual size of area.
+    uint8_t areaHeader[3] = {0};
+    std::memcpy(areaHeader, &fruData[areaOffset], sizeof(areaHeader));
+
+    // Size of this area will be the 2nd byte in the FRU area header.
+    // The multirecord area goes on until its last record, which walking the
+    // records finds, checking each of them on the way.
+    size_t areaLen;
+    if (fruEntry == IPMI_FRU_MULTI_OFFSET)
+    {
+        auto records = std::span(&fruData[areaOffset], dataLen - areaOffset);
+        ipmi_fru_multirec_t record{};
+        areaLen = 0;
+        while (!record.end_of_list)
+        {
+            if (ipmi_fru_multirec_next(records, &areaLen, &record) < 0)
+            {
+                lg2::error("Err validating FRU area, offset: {OFFSET}",
+                           "OFFSET", areaOffset);
+                return rc;
+            }
+        }
+    }
+    else
+    {
+        areaLen = areaHeader[1] * IPMI_EIGHT_BYTES;
+    }
+
+    FRU_DEBUG(
+        "FRU Data, size: {SIZE}, area offset: {OFFSET}, area size: {AREA_SIZE}",
+        "SIZE", dataLen, "OFFSET", areaOffset, "AREA_SIZE", areaLen);
+
+    // See if we really have that much buffer. We have area offset amd from
+    // there, the actual len.
+    if (dataLen < (areaLen + areaOffset))
+    {
+        lg2::error("Incomplete FRU file, size: {SIZE}", "SIZE", dataLen);
+        return rc;
+    }
+
+    // The areas are views into the FRU image, nothing is copied.
+    areaData = std::span<const uint8_t>(&fruData[areaOffset], areaLen);
+
+    // Validate the CRC, but not for the internal use area, since its
+    // contents beyond the first byte are not defined in the spec and it may
+    // not end with a CRC byte. The multirecord area's records have been
+    // validated already.
+    bool validateCrc = fruEntry != IPMI_FRU_INTERNAL_OFFSET;
+
+    if (fruEntry == IPMI_FRU_MULTI_OFFSET)
+    {
+        rc = EXIT_SUCCESS;
+    }
+    else
+    {
+        rc = verifyFruData(areaData.data(), areaLen, validateCrc);
+    }
+
+    if (rc < 0)
+    {
+        lg2::error("Err validating FRU area, offset: {OFFSET}", "OFFSET",
+                   areaOffset);
+        return rc;
+    }
+    FRU_DEBUG("Successfully verified area, offset: {OFFSET}", "OFFSET",
+              areaOffset);
+
+    return EXIT_SUCCESS;
+}
+
 /**
  * Populates various FRU areas.
  *
@@ -460,9 +1141,11 @@ bool removeInvalidArea(const std::unique_ptr<IPMIFruArea>& fruArea)
  * @param[in] dataLen - the length of the FRU data
  * @param[in] fruAreaVec - the FRU area vector to update
  */
-int ipmiPopulateFruAreas(uint8_t* fruData, const size_t dataLen,
+int ipmiPopulateFruAreas(const uint8_t* fruData, const size_t dataLen,
                          FruAreaVector& fruAreaVec)
 {
+    FRU_TRACE(populate_fru_areas_entry, dataLen);
+
     // Now walk the common header and see if the file size has at least the last
     // offset mentioned by the struct common_header. If the file size is less
     // than the offset of any if the FRU areas mentioned in the common header,
@@ -470,87 +1153,27 @@ int ipmiPopulateFruAreas(uint8_t* fruData, const size_t dataLen,
     for (uint8_t fruEntry = IPMI_FRU_INTERNAL_OFFSET;
          fruEntry < (sizeof(struct common_header) - 2); fruEntry++)
     {
-        int rc = -1;
-        // Actual offset in the payload is the offset mentioned in common header
-        // multiplied by 8. Common header is always the first 8 bytes.
-        size_t areaOffset = fruData[fruEntry] * IPMI_EIGHT_BYTES;
-        if (areaOffset && (dataLen < (areaOffset + 2)))
+        std::span<const uint8_t> areaData;
+        int rc = ipmiValidateFruArea(fruData, dataLen, fruEntry, areaData);
+        if (rc < 0)
         {
-            // Our file size is less than what it needs to be. +2 because we are
-            // using area len that is at 2 byte off areaOffset
-            lg2::error("FRU file is incomplete, size: {SIZE}", "SIZE", dataLen);
+            FRU_TRACE(populate_fru_areas_bad_area, fruEntry, rc);
+            FRU_TRACE(populate_fru_areas_return, rc, 0);
             return rc;
         }
-        else if (areaOffset)
-        {
-            // Read 3 bytes to know the actual size of area.
-            uint8_t areaHeader[3] = {0};
-            std::memcpy(areaHeader, &((uint8_t*)fruData)[areaOffset],
-                        sizeof(areaHeader));
-
-            // Size of this area will be the 2nd byte in the FRU area header.
-            size_t areaLen;
-            if (fruEntry == IPMI_FRU_MULTI_OFFSET)
-            {
-                areaLen = areaHeader[2] + IPMI_FRU_MULTIREC_HDR_BYTES;
-            }
-            else
-            {
-                areaLen = areaHeader[1] * IPMI_EIGHT_BYTES;
-            }
-
-            lg2::debug(
-                "FRU Data, size: {SIZE}, area offset: {OFFSET}, area size: {AREA_SIZE}",
-                "SIZE", dataLen, "OFFSET", areaOffset, "AREA_SIZE", areaLen);
-
-            // See if we really have that much buffer. We have area offset amd
-            // from there, the actual len.
-            if (dataLen < (areaLen + areaOffset))
-            {
-                lg2::error("Incomplete FRU file, size: {SIZE}", "SIZE",
-                           dataLen);
-                return rc;
-            }
-
-            auto fruDataView =
-                std::span<uint8_t>(&fruData[areaOffset], areaLen);
-            auto areaData =
-                std::vector<uint8_t>(fruDataView.begin(), fruDataView.end());
-
-            // Validate the CRC, but not for the internal use area, since its
-            // contents beyond the first byte are not defined in the spec and
-            // it may not end with a CRC byte.
-            bool validateCrc = fruEntry != IPMI_FRU_INTERNAL_OFFSET;
-
-            if (fruEntry == IPMI_FRU_MULTI_OFFSET)
-            {
-                rc = verifyFruMultiRecData(areaData.data(), areaLen,
-                                           validateCrc);
-            }
-            else
-            {
-                rc = verifyFruData(areaData.data(), areaLen, validateCrc);
-            }
-
-            if (rc < 0)
-            {
-                lg2::error("Err validating FRU area, offset: {OFFSET}",
-                           "OFFSET", areaOffset);
-                return rc;
-            }
-            lg2::debug("Successfully verified area, offset: {OFFSET}", "OFFSET",
-                       areaOffset);
 
-            // We already have a vector that is passed to us containing all
-            // of the fields populated. Update the data portion now.
+        // We already have a vector that is passed to us containing all of the
+        // fields populated. Update the data portion now.
+        if (!areaData.empty())
+        {
             for (auto& iter : fruAreaVec)
             {
                 if (iter->getType() == getFruAreaType(fruEntry))
                 {
-                    iter->setData(areaData.data(), areaLen);
+                    iter->setData(areaData);
                 }
             }
-        } // If we have FRU data present
+        }
     } // Walk struct common_header
 
     // Not all the fields will be populated in a FRU data. Mostly all cases will
@@ -559,6 +1182,7 @@ int ipmiPopulateFruAreas(uint8_t* fruData, const size_t dataLen,
         std::remove_if(fruAreaVec.begin(), fruAreaVec.end(), removeInvalidArea),
         fruAreaVec.end());
 
+    FRU_TRACE(populate_fru_areas_return, EXIT_SUCCESS, fruAreaVec.size());
     return EXIT_SUCCESS;
 }
 
@@ -585,6 +1209,13 @@ int ipmiValidateCommonHeader(const uint8_t* fruData, const size_t dataLen)
         return rc;
     }
 
+    if (isBlankFruHeader(commonHdr, sizeof(commonHdr)))
+    {
+        lg2::error("FRU is blank, common header is all {BYTE}", "BYTE",
+                   lg2::hex, commonHdr[0]);
+        return rc;
+    }
+
     // Verify the CRC and size
     rc = verifyFruData(commonHdr, sizeof(commonHdr), true);
     if (rc < 0)
@@ -596,15 +1227,164 @@ int ipmiValidateCommonHeader(const uint8_t* fruData, const size_t dataLen)
     return EXIT_SUCCESS;
 }
 
-int validateFRUArea(const uint8_t fruid, const char* fruFilename,
-                    sdbusplus::bus_t& bus)
+bool isBlankFruHeader(const uint8_t* fruData, const size_t dataLen)
+{
+    if (dataLen < sizeof(struct common_header))
+    {
+        return false;
+    }
+
+    // Unprogrammed parts read back as all ones, some are shipped zeroed.
+    auto header = std::span(fruData, sizeof(struct common_header));
+    return std::ranges::all_of(header, [](uint8_t b) { return b == 0xFF; }) ||
+           std::ranges::all_of(header, [](uint8_t b) { return b == 0x00; });
+}
+
+bool getFruAreaExtents(const uint8_t* fruData, const size_t dataLen,
+                       std::vector<std::pair<size_t, size_t>>& extents)
+{
+    extents.clear();
+
+    // The offsets can only be trusted once the whole common header is there
+    // and its checksum matches.
+    if (dataLen < sizeof(struct common_header) ||
+        fruData[0] != IPMI_FRU_HDR_BYTE_ZERO ||
+        calculateCRC(fruData, IPMI_FRU_HDR_CRC_OFFSET) !=
+            fruData[IPMI_FRU_HDR_CRC_OFFSET])
+    {
+        extents.emplace_back(0, sizeof(struct common_header));
+        return false;
+    }
+
+    bool complete = true;
+    for (uint8_t fruEntry = IPMI_FRU_INTERNAL_OFFSET;
+         fruEntry < (sizeof(struct common_header) - 2); fruEntry++)
+    {
+        size_t areaOffset = fruData[fruEntry] * IPMI_EIGHT_BYTES;
+        if (!areaOffset)
+        {
+            continue;
+        }
+
+        // Area length is in the area header, at most 3 bytes in.
+        if (fruEntry != IPMI_FRU_MULTI_OFFSET)
+        {
+            if (dataLen < (areaOffset + 3))
+            {
+                extents.emplace_back(areaOffset, 3);
+                complete = false;
+                continue;
+            }
+
+            size_t areaLen = fruData[areaOffset + 1] * IPMI_EIGHT_BYTES;
+            extents.emplace_back(areaOffset, std::max<size_t>(areaLen, 3));
+            continue;
+        }
+
+        // The multirecord area is as long as its records, each record's
+        // header has its length and whether it is the last one.
+        size_t areaLen = 0;
+        bool endOfList = false;
+        while (!endOfList)
+        {
+            if (dataLen < (areaOffset + areaLen + IPMI_FRU_MULTIREC_HDR_BYTES))
+            {
+                areaLen += IPMI_FRU_MULTIREC_HDR_BYTES;
+                complete = false;
+                break;
+            }
+
+            const uint8_t* record = &fruData[areaOffset + areaLen];
+            endOfList = record[1] & IPMI_FRU_MULTIREC_END_OF_LIST;
+            areaLen += IPMI_FRU_MULTIREC_HDR_BYTES + record[2];
+        }
+        extents.emplace_back(areaOffset, areaLen);
+    }
+
+    return complete;
+}
+
+size_t getFruImageLength(const uint8_t* fruData, const size_t dataLen)
+{
+    std::vector<std::pair<size_t, size_t>> extents;
+    if (!getFruAreaExtents(fruData, dataLen, extents))
+    {
+        return 0;
+    }
+
+    size_t imageLen = sizeof(struct common_header);
+    for (const auto& [areaOffset, areaLen] : extents)
+    {
+        imageLen = std::max(imageLen, areaOffset + areaLen);
+    }
+
+    return imageLen;
+}
+
+namespace
+{
+
+// The offset and length of each area of a FRU image, by area type. Areas
+// the image doesn't have are zero length.
+using FruAreaExtents =
+    std::array<std::pair<size_t, size_t>, IPMI_FRU_AREA_TYPE_MAX>;
+
+/**
+ * The last image of a FRU that validated, to answer reads of it from, and
+ * what it parsed into, so that changes to it only need the areas they touch
+ * parsed again.
+ */
+struct FruImage
+{
+    std::vector<uint8_t> data;
+    FruAreaExtents areas{};
+
+    // Not set for images that were taken from the parsed FRU cache.
+    std::optional<IPMIFruInfo> info;
+};
+
+std::map<uint8_t, FruImage> fruImages;
+
+/**
+ * Keep an image that validated in memory.
+ *
+ * @param[in] fruid - The ID of the FRU.
+ * @param[in] fruData - the FRU image.
+ * @param[in] areas - where the areas are in the image.
+ * @param[in] info - what the image parsed into, if it was parsed.
+ */
+void storeFruImage(const uint8_t fruid, std::span<const uint8_t> fruData,
+                   const FruAreaExtents& areas, const IPMIFruInfo* info)
+{
+    auto& image = fruImages[fruid];
+    image.data.assign(fruData.begin(), fruData.end());
+    image.areas = areas;
+    if (info)
+    {
+        image.info = *info;
+    }
+    else
+    {
+        image.info.reset();
+    }
+}
+
+/**
+ * Validate a FRU image and parse all of its areas.
+ *
+ * @param[in] fruid - The ID to use for this FRU.
+ * @param[in] fruData - the FRU image.
+ * @param[out] info - the parsed FRU data.
+ * @param[out] areas - where the areas are in the image.
+ * @return non-zero on failure
+ */
+int parseFRU(const uint8_t fruid, std::span<const uint8_t> fruData,
+             IPMIFruInfo& info, FruAreaExtents& areas)
 {
-    size_t dataLen = 0;
-    size_t bytesRead = 0;
     int rc = -1;
 
-    // Vector that holds individual IPMI FRU AREAs. Although MULTI and INTERNAL
-    // are not used, keeping it here for completeness.
+    // Vector that holds individual IPMI FRU AREAs. Although INTERNAL is not
+    // used, keeping it here for completeness.
     FruAreaVector fruAreaVec;
 
     for (uint8_t fruEntry = IPMI_FRU_INTERNAL_OFFSET;
@@ -614,87 +1394,305 @@ int validateFRUArea(const uint8_t fruid, const char* fruFilename,
         std::unique_ptr<IPMIFruArea> fruArea =
             std::make_unique<IPMIFruArea>(fruid, getFruAreaType(fruEntry));
 
-        // Physically being present
-        bool present = access(fruFilename, F_OK) == 0;
-        fruArea->setPresent(present);
+        // Physically being present, since we have its data.
+        fruArea->setPresent(true);
 
         fruAreaVec.emplace_back(std::move(fruArea));
     }
 
-    FILE* fruFilePointer = std::fopen(fruFilename, "rb");
-    if (fruFilePointer == nullptr)
     {
-        lg2::error("Unable to open {FILE}, error: {ERRNO}", "FILE", fruFilename,
-                   "ERRNO", std::strerror(errno));
-        return cleanupError(fruFilePointer, fruAreaVec);
+        FruStageTimer timer(fruid, FruStage::validateHeader);
+        rc = ipmiValidateCommonHeader(fruData.data(), fruData.size());
+    }
+    if (rc < 0)
+    {
+        return cleanupError(nullptr, fruAreaVec);
+    }
+
+    // Now that we validated the common header, populate various FRU sections if
+    // we have them here.
+    {
+        FruStageTimer timer(fruid, FruStage::populateAreas);
+        rc = ipmiPopulateFruAreas(fruData.data(), fruData.size(), fruAreaVec);
+    }
+    if (rc < 0)
+    {
+        lg2::error("Populating fru id:({FRUID}) areas failed", "FRUID", fruid);
+        return cleanupError(nullptr, fruAreaVec);
+    }
+    FRU_DEBUG("Populated FRU areas, fru id: {FRUID}", "FRUID", fruid);
+
+    areas = {};
+    for (const auto& iter : fruAreaVec)
+    {
+        FRU_DEBUG("fru id: {FRUID}", "FRUID", iter->getFruID());
+        FRU_DEBUG("area name: {AREA}", "AREA", iter->getName());
+        FRU_DEBUG("type: {TYPE}", "TYPE", iter->getType());
+        FRU_DEBUG("length: {LEN}", "LEN", iter->getLength());
+        areas[iter->getType()] = {iter->getData().data() - fruData.data(),
+                                  iter->getLength()};
     }
 
-    // Get the size of the file to see if it meets minimum requirement
-    if (std::fseek(fruFilePointer, 0, SEEK_END))
+    // For each FRU area, extract the needed data and get it parsed.
+    FruStageTimer timer(fruid, FruStage::parse);
+    for (const auto& fruArea : fruAreaVec)
     {
-        lg2::error("Unable to seek {FILE}, error: {ERRNO}", "FILE", fruFilename,
-                   "ERRNO", std::strerror(errno));
-        return cleanupError(fruFilePointer, fruAreaVec);
+        // Fill the container with information
+        rc = parse_fru_area(fruArea->getType(), fruArea->getData(), info);
+        if (rc < 0)
+        {
+            lg2::error("Error parsing FRU records: {RC}", "RC", rc);
+            return rc;
+        }
     }
 
-    // Allocate a buffer to hold entire file content
-    dataLen = std::ftell(fruFilePointer);
+    return rc;
+}
 
-    auto fruData = std::vector<uint8_t>(dataLen, 0);
+/**
+ * Validate a FRU image that is an update of the last one that validated,
+ * and parse it. Only the areas that the update changed are validated and
+ * parsed again, the others are known to parse into what they did before.
+ *
+ * @param[in] fruid - The ID to use for this FRU.
+ * @param[in] fruData - the FRU image.
+ * @param[in] dirty - the offset and length of the bytes that may differ
+ *                    from the last image.
+ * @param[out] info - the parsed FRU data.
+ * @param[out] areas - where the areas are in the image.
+ * @return non-zero on failure
+ */
+int reparseFRU(const uint8_t fruid, std::span<const uint8_t> fruData,
+               std::pair<size_t, size_t> dirty, IPMIFruInfo& info,
+               FruAreaExtents& areas)
+{
+    // A new common header may move any of the areas, so all of them have to
+    // be looked at again. So does an image that wasn't parsed here.
+    auto iter = fruImages.find(fruid);
+    if (iter == fruImages.end() || !iter->second.info ||
+        fruData.size() < sizeof(struct common_header) ||
+        !std::equal(fruData.begin(),
+                    fruData.begin() + sizeof(struct common_header),
+                    iter->second.data.begin()))
+    {
+        return parseFRU(fruid, fruData, info, areas);
+    }
+    const auto& last = iter->second;
 
-    std::rewind(fruFilePointer);
-    bytesRead = std::fread(fruData.data(), dataLen, 1, fruFilePointer);
-    if (bytesRead != 1)
+    auto [dirtyOffset, dirtyLen] = dirty;
+    info = *last.info;
+    areas = last.areas;
+    for (uint8_t fruEntry = IPMI_FRU_INTERNAL_OFFSET;
+         fruEntry < (sizeof(struct common_header) - 2); fruEntry++)
     {
-        lg2::error(
-            "Failed to reading FRU data, bytesRead: {BYTESREAD}, errno: {ERRNO}",
-            "BYTESREAD", bytesRead, "ERRNO", std::strerror(errno));
-        return cleanupError(fruFilePointer, fruAreaVec);
+        auto type = getFruAreaType(fruEntry);
+        auto [areaOffset, areaLen] = last.areas[type];
+
+        // An area that wasn't written to, or was written with what it had
+        // already, is the same area.
+        if (!fruData[fruEntry])
+        {
+            continue;
+        }
+        if (areaLen && areaOffset + areaLen <= fruData.size() &&
+            (areaOffset >= dirtyOffset + dirtyLen ||
+             dirtyOffset >= areaOffset + areaLen ||
+             std::equal(last.data.begin() + areaOffset,
+                        last.data.begin() + areaOffset + areaLen,
+                        fruData.begin() + areaOffset)))
+        {
+            continue;
+        }
+
+        std::span<const uint8_t> areaData;
+        int rc;
+        {
+            FruStageTimer timer(fruid, FruStage::populateAreas);
+            rc = ipmiValidateFruArea(fruData.data(), fruData.size(), fruEntry,
+                                     areaData);
+        }
+        if (rc < 0)
+        {
+            lg2::error("Validating fru id:({FRUID}) area {TYPE} failed",
+                       "FRUID", fruid, "TYPE", type);
+            return -1;
+        }
+        areas[type] = {fruData[fruEntry] * IPMI_EIGHT_BYTES, areaData.size()};
+
+        FRU_DEBUG("Parsing changed area {TYPE}, fru id: {FRUID}", "TYPE",
+                  type, "FRUID", fruid);
+        FruStageTimer timer(fruid, FruStage::parse);
+        clear_fru_area(type, info);
+        if (parse_fru_area(type, areaData, info) < 0)
+        {
+            lg2::error("Error parsing FRU records of area {TYPE}", "TYPE",
+                       type);
+            return -1;
+        }
     }
 
-    // We are done reading.
-    std::fclose(fruFilePointer);
-    fruFilePointer = nullptr;
+    return 0;
+}
+
+} // namespace
+
+int validateFRUArea(const uint8_t fruid, std::span<const uint8_t> fruData,
+                    std::pair<size_t, size_t> dirty, sdbusplus::bus_t& bus)
+{
+    FRU_TRACE(validate_fru_area_entry, fruid, fruData.size(), dirty.first,
+              dirty.second);
+
+    ParsedFru parsedFru{fruid, {}};
+    FruAreaExtents areas;
 
-    rc = ipmiValidateCommonHeader(fruData.data(), dataLen);
+    int rc = reparseFRU(fruid, fruData, dirty, parsedFru.info, areas);
     if (rc < 0)
     {
-        return cleanupError(fruFilePointer, fruAreaVec);
+        FRU_TRACE(validate_fru_area_return, fruid, rc);
+        return rc;
     }
+    storeFruImage(fruid, fruData, areas, &parsedFru.info);
 
-    // Now that we validated the common header, populate various FRU sections if
-    // we have them here.
-    rc = ipmiPopulateFruAreas(fruData.data(), dataLen, fruAreaVec);
+    rc = updateInventoryAsync({&parsedFru, 1}, bus);
     if (rc < 0)
     {
-        lg2::error("Populating fru id:({FRUID}) areas failed", "FRUID", fruid);
-        return cleanupError(fruFilePointer, fruAreaVec);
+        lg2::error("Error updating inventory.");
     }
-    lg2::debug("Populated FRU areas, file name: {FILE}", "FILE", fruFilename);
 
-    for (const auto& iter : fruAreaVec)
+    FRU_TRACE(validate_fru_area_return, fruid, rc);
+    return rc;
+}
+
+int validateFRUArea(const uint8_t fruid, std::span<const uint8_t> fruData,
+                    sdbusplus::bus_t& bus)
+{
+    return validateFRUArea(fruid, fruData, {0, fruData.size()}, bus);
+}
+
+int validateFRUArea(const uint8_t fruid, const char* fruFilename,
+                    sdbusplus::bus_t& bus)
+{
+    std::pair<uint8_t, std::string> fruFile{fruid, fruFilename};
+
+    return validateFRUAreas({&fruFile, 1}, bus);
+}
+
+int validateFRUAreas(std::span<const std::pair<uint8_t, std::string>> fruFiles,
+                     sdbusplus::bus_t& bus)
+{
+    std::vector<ParsedFru> parsedFrus(fruFiles.size());
+    std::vector<FruAreaExtents> areas(fruFiles.size());
+    std::vector<std::string> fruFilenames;
+    std::vector<std::vector<uint8_t>> fruData;
+
+    // Read all the images up front, so that slow devices are waited for
+    // concurrently rather than one after the other.
+    std::vector<uint8_t> fruids;
+    for (const auto& [fruid, fruFilename] : fruFiles)
+    {
+        fruids.push_back(fruid);
+        fruFilenames.push_back(fruFilename);
+    }
+    FRU_TRACE(read_fru_files_entry, fruFiles.size());
+    auto start = std::chrono::steady_clock::now();
+    std::vector<int> results = readFRUFiles(fruFilenames, fruData);
+    recordFruStage(fruids, FruStage::read,
+                   std::chrono::steady_clock::now() - start);
+    FRU_TRACE(read_fru_files_return, fruFiles.size());
+    for (size_t i = 0; i < fruFiles.size(); i++)
     {
-        lg2::debug("fru id: {FRUID}", "FRUID", iter->getFruID());
-        lg2::debug("area name: {AREA}", "AREA", iter->getName());
-        lg2::debug("type: {TYPE}", "TYPE", iter->getType());
-        lg2::debug("length: {LEN}", "LEN", iter->getLength());
+        countFruEvent(fruids[i], FruCounter::readBytes, fruData[i].size());
+
+        // Each image is validated from here on, all of it.
+        FRU_TRACE(validate_fru_area_entry, fruids[i], fruData[i].size(), 0,
+                  fruData[i].size());
     }
 
-    // If the vector is populated with everything, then go ahead and update the
-    // inventory.
-    if (!(fruAreaVec.empty()))
+    // Parsing the images doesn't touch any shared state, so spread it across
+    // the cores. Images that were parsed before are taken from the cache
+    // instead. Publishing them is done in one go below.
+    std::atomic<size_t> next = 0;
+    auto worker = [&]() {
+        for (size_t i = next++; i < fruFiles.size(); i = next++)
+        {
+            auto& parsedFru = parsedFrus[i];
+            parsedFru.fruid = fruFiles[i].first;
+            if (results[i] < 0)
+            {
+                continue;
+            }
+
+            parsedFru.cached =
+                loadCachedFru(fruFilenames[i], fruData[i], parsedFru.info);
+            if (parsedFru.cached)
+            {
+                continue;
+            }
+
+            results[i] = parseFRU(parsedFru.fruid, fruData[i], parsedFru.info,
+                                  areas[i]);
+        }
+    };
+
+    size_t threadCount = std::min<size_t>(
+        fruFiles.size(), std::max(1U, std::thread::hardware_concurrency()));
     {
-        lg2::debug("fruAreaVec size: {SIZE}", "SIZE", fruAreaVec.size());
-        rc = updateInventory(fruAreaVec, bus);
-        if (rc < 0)
+        std::vector<std::jthread> threads;
+        for (size_t i = 1; i < threadCount; i++)
+        {
+            threads.emplace_back(worker);
+        }
+        worker();
+    }
+
+    int rc = 0;
+    std::vector<ParsedFru> validFrus;
+    std::vector<size_t> validIndices;
+    for (size_t i = 0; i < fruFiles.size(); i++)
+    {
+        if (results[i] < 0)
+        {
+            lg2::error("Skipping fru id:({FRUID}) from {FILE}", "FRUID",
+                       fruFiles[i].first, "FILE", fruFiles[i].second);
+            rc = -1;
+            continue;
+        }
+        storeFruImage(fruFiles[i].first, fruData[i], areas[i],
+                      parsedFrus[i].cached ? nullptr : &parsedFrus[i].info);
+        validFrus.emplace_back(std::move(parsedFrus[i]));
+        validIndices.push_back(i);
+    }
+
+    if (updateInventory(validFrus, bus) < 0)
+    {
+        lg2::error("Error updating inventory.");
+        rc = -1;
+    }
+
+    // Only cache what was published, so that a cache hit also means the
+    // inventory manager was sent the data. The update fails for a FRU ID
+    // missing from the generated tables, that doesn't keep the others from
+    // being cached.
+    for (size_t j = 0; j < validFrus.size(); j++)
+    {
+        if (!validFrus[j].cached && isFruPublished(validFrus[j].fruid))
         {
-            lg2::error("Error updating inventory.");
+            size_t i = validIndices[j];
+            storeCachedFru(fruFilenames[i], fruData[i], validFrus[j].info);
         }
     }
 
-    // we are done with all that we wanted to do. This will do the job of
-    // calling any destructors too.
-    fruAreaVec.clear();
+    for (size_t i = 0; i < fruFiles.size(); i++)
+    {
+        FRU_TRACE(validate_fru_area_return, fruids[i],
+                  results[i] < 0 || !isFruPublished(fruids[i]) ? -1 : 0);
+    }
 
     return rc;
 }
+
+const std::vector<uint8_t>* getFruImage(const uint8_t fruid)
+{
+    auto iter = fruImages.find(fruid);
+    return iter == fruImages.end() ? nullptr : &iter->second.data;
+}
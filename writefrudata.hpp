@@ -1,8 +1,18 @@
 #ifndef __IPMI_WRITE_FRU_DATA_H__
 #define __IPMI_WRITE_FRU_DATA_H__
 
+#include "frup.hpp"
+#include "types.hpp"
+
 #include <sdbusplus/bus.hpp>
 
+#include <cstdint>
+#include <functional>
+#include <span>
+#include <string>
+#include <utility>
+#include <vector>
+
 // Format of write fru data command
 struct write_fru_data_t
 {
@@ -34,7 +44,44 @@ struct common_header
 #define IPMI_FRU_MULTI_OFFSET offsetof(struct common_header, multi_offset)
 #define IPMI_FRU_HDR_CRC_OFFSET offsetof(struct common_header, crc)
 #define IPMI_EIGHT_BYTES 8
-#define IPMI_FRU_MULTIREC_HDR_BYTES 5
+
+/**
+ * The parsed data of a FRU image.
+ */
+struct ParsedFru
+{
+    uint8_t fruid;
+    IPMIFruInfo info;
+
+    // Whether the data came from the parsed FRU cache, i.e. the image is
+    // the same as the last time it was parsed and published.
+    bool cached = false;
+};
+
+/**
+ * Sends objects to the inventory manager.
+ *
+ * @param[in] objects - the objects to send.
+ * @param[in] fruids - the FRUs the objects are for.
+ * @return non-zero on failure.
+ */
+using InventoryNotify = std::function<int(ipmi::vpd::ObjectMap& objects,
+                                          std::span<const uint8_t> fruids)>;
+
+/**
+ * Update the inventory with parsed FRU data, sending only what the inventory
+ * manager doesn't have already, all of it in one call.
+ *
+ * The validate functions send it to the inventory manager on D-Bus. Any
+ * other notify, e.g. a stub to measure building the objects with, gets the
+ * same objects they would have sent.
+ *
+ * @param[in] parsedFrus - the FRU IDs and their parsed data.
+ * @param[in] notify - sends the objects to the inventory manager.
+ * @return non-zero on failure.
+ */
+int updateInventory(std::span<const ParsedFru> parsedFrus,
+                    const InventoryNotify& notify);
 
 /**
  * Validate a FRU.
@@ -46,4 +93,109 @@ struct common_header
 int validateFRUArea(const uint8_t fruid, const char* fruFilename,
                     sdbusplus::bus_t& bus);
 
+/**
+ * Validate a FRU image that is already in memory.
+ *
+ * The image is parsed before returning, but it is published without waiting
+ * for the inventory manager, whose reply comes in through the event loop the
+ * bus is attached to. Failures to publish are logged.
+ *
+ * @param[in] fruid - The ID to use for this FRU.
+ * @param[in] fruData - the FRU image.
+ * @param[in] bus - an sdbusplus systemd bus for publishing the information.
+ */
+int validateFRUArea(const uint8_t fruid, std::span<const uint8_t> fruData,
+                    sdbusplus::bus_t& bus);
+
+/**
+ * Validate a FRU image that is already in memory, of which only part may
+ * have changed since it last validated. Only the areas the changed part
+ * overlaps are validated and parsed again. Like the above, it is published
+ * without waiting for the inventory manager.
+ *
+ * @param[in] fruid - The ID to use for this FRU.
+ * @param[in] fruData - the FRU image.
+ * @param[in] dirty - the offset and length of the part that may have
+ *                    changed.
+ * @param[in] bus - an sdbusplus systemd bus for publishing the information.
+ */
+int validateFRUArea(const uint8_t fruid, std::span<const uint8_t> fruData,
+                    std::pair<size_t, size_t> dirty, sdbusplus::bus_t& bus);
+
+/**
+ * Validate several FRUs, reading and parsing them in parallel, and publish
+ * all of them with a single call to the inventory manager.
+ *
+ * @param[in] fruFiles - the IDs and filenames of the FRUs.
+ * @param[in] bus - an sdbusplus systemd bus for publishing the information.
+ * @return non-zero if any of the FRUs could not be published.
+ */
+int validateFRUAreas(std::span<const std::pair<uint8_t, std::string>> fruFiles,
+                     sdbusplus::bus_t& bus);
+
+/**
+ * Get the last image of a FRU that was validated, as kept in memory by the
+ * validate functions.
+ *
+ * @param[in] fruid - the FRU ID.
+ * @return the image, or nullptr if no image of the FRU has been validated.
+ */
+const std::vector<uint8_t>* getFruImage(const uint8_t fruid);
+
+/**
+ * Calculate the zero checksum of a run of FRU bytes, per the IPMI FRU
+ * specification.
+ *
+ * @param[in] data - the bytes to checksum.
+ * @param[in] len - the number of bytes.
+ * @return the value that makes the bytes plus it sum to zero.
+ */
+unsigned char calculateCRC(const unsigned char* data, size_t len);
+
+/**
+ * Validate the common header of a FRU image.
+ *
+ * @param[in] fruData - the FRU bytes.
+ * @param[in] dataLen - the number of bytes in fruData.
+ * @return non-zero if the header is missing, blank or not valid.
+ */
+int ipmiValidateCommonHeader(const uint8_t* fruData, const size_t dataLen);
+
+/**
+ * Check whether a FRU image's common header is that of a blank part, all
+ * 0xFF or all 0x00.
+ *
+ * @param[in] fruData - the FRU bytes available so far.
+ * @param[in] dataLen - the number of bytes in fruData.
+ * @return whether the common header is there and blank.
+ */
+bool isBlankFruHeader(const uint8_t* fruData, const size_t dataLen);
+
+/**
+ * Get the offset and length of every area a FRU image's common header
+ * references.
+ *
+ * The extents are worked out from what is in fruData. When that isn't
+ * enough, they also cover what is needed to get further, i.e. the common
+ * header, the area headers or the next multirecord header, and reading
+ * those in and calling this again eventually gets all of them.
+ *
+ * @param[in] fruData - the FRU bytes available so far.
+ * @param[in] dataLen - the number of bytes in fruData.
+ * @param[out] extents - the offset and length of each area.
+ * @return false if the extents can't be determined from fruData yet.
+ */
+bool getFruAreaExtents(const uint8_t* fruData, const size_t dataLen,
+                       std::vector<std::pair<size_t, size_t>>& extents);
+
+/**
+ * Get the length of a FRU image as declared by its common header.
+ *
+ * @param[in] fruData - the FRU bytes available so far.
+ * @param[in] dataLen - the number of bytes in fruData.
+ * @return the number of bytes spanned by the common header and every area
+ *         it references, or 0 if that can't be determined from fruData yet.
+ */
+size_t getFruImageLength(const uint8_t* fruData, const size_t dataLen);
+
 #endif